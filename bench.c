@@ -0,0 +1,744 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the Pip API microbenchmarks. Each benchmark takes
+ * BENCH_ITERATIONS cycle samples of one Pip call and prints a summary line
+ * and a histogram line over the serial link:
+ *
+ * BENCH <name> n=<samples> min=<cycles> median=<cycles> p99=<cycles> max=<cycles>
+ * BENCH <name> hist <bucket>:<samples> ...
+ *
+ * Bucket k counts the samples taking from 2^k to 2^(k+1)-1 cycles, only the
+ * non-empty buckets are printed.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/paging.h>
+#include <pip/vidt.h>
+#include <pip/api.h>
+#include <pip/wrappers.h>
+
+#include "launcher.h"
+#include "bench.h"
+#include "cycles.h"
+#include "fpu.h"
+#include "grant.h"
+#include "map.h"
+#include "pageops.h"
+#include "pool.h"
+#include "snapshot.h"
+
+/*!
+ * \def BENCH_OWNER
+ * \brief The page pool owner of the pages used by the benchmarks
+ */
+#define BENCH_OWNER	POOL_OWNER(MAX_PARTITIONS)
+
+/*!
+ * \brief The samples of the running benchmark
+ */
+static uint32_t samples[BENCH_ITERATIONS];
+
+/*!
+ * \fn void benchHandler(void)
+ * \brief Handler registered by the Pip_RegisterInterrupt benchmark, never
+ *        triggered
+ */
+static void benchHandler(void)
+{
+	PANIC();
+}
+
+/*!
+ * \fn static void report(const char *name, uint32_t count)
+ * \brief Print the summary and the histogram of the samples
+ * \param name The name of the benchmark
+ * \param count The number of samples
+ */
+static void report(const char *name, uint32_t count)
+{
+	uint32_t buckets[32] = { 0 };
+
+	if (!count)
+	{
+		printf("BENCH %s n=0\n", name);
+		return;
+	}
+
+	// Insertion sort, the samples being few
+	for (uint32_t i = 1; i < count; i++)
+	{
+		uint32_t sample = samples[i];
+		uint32_t j = i;
+
+		for (; j > 0 && samples[j - 1] > sample; j--)
+		{
+			samples[j] = samples[j - 1];
+		}
+
+		samples[j] = sample;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t bucket = 0;
+
+		for (uint32_t value = samples[i]; value > 1; value >>= 1)
+		{
+			bucket++;
+		}
+
+		buckets[bucket]++;
+	}
+
+	printf("BENCH %s n=%d min=%d median=%d p99=%d max=%d\n", name, count,
+			samples[0], samples[count / 2],
+			samples[(count * 99) / 100], samples[count - 1]);
+
+	printf("BENCH %s hist", name);
+
+	for (uint32_t i = 0; i < 32; i++)
+	{
+		if (buckets[i])
+		{
+			printf(" %d:%d", i, buckets[i]);
+		}
+	}
+
+	printf("\n");
+}
+
+/*!
+ * \fn static uint32_t createPartition(void)
+ * \brief Create a partition for the benchmarks
+ * \return The partition descriptor, 0 in the case of a failure
+ */
+static uint32_t createPartition(void)
+{
+	uint32_t pages[5];
+
+	for (uint32_t i = 0; i < 5; i++)
+	{
+		pages[i] = (uint32_t) poolAllocZeroedPage();
+
+		if (!pages[i])
+		{
+			poolRelease(BENCH_OWNER);
+			return 0;
+		}
+	}
+
+	if (!Pip_CreatePartition(pages[0], pages[1], pages[2], pages[3],
+			pages[4]))
+	{
+		poolRelease(BENCH_OWNER);
+		return 0;
+	}
+
+	return pages[0];
+}
+
+/*!
+ * \fn static void deletePartition(uint32_t descChild)
+ * \brief Delete a partition created for the benchmarks and recycle its pages
+ * \param descChild The partition descriptor
+ */
+static void deletePartition(uint32_t descChild)
+{
+	if (!Pip_DeletePartition(descChild))
+	{
+		printf("Pip_DeletePartition failed ...\n");
+		PANIC();
+	}
+
+	poolRelease(BENCH_OWNER);
+}
+
+/*!
+ * \fn void benchPipCalls(void)
+ * \brief Benchmark the Pip calls used to build a partition
+ */
+void benchPipCalls(void)
+{
+	uint32_t count, descChild;
+
+	poolSetOwner(BENCH_OWNER);
+	uint32_t category = poolSetCategory(POOL_BENCH);
+
+	// Pip_AllocPage, each page being handed over to the pool
+	for (count = 0; count < BENCH_ITERATIONS; count++)
+	{
+		uint64_t start = readCycles();
+		uint32_t *page = Pip_AllocPage();
+		samples[count] = (uint32_t) (readCycles() - start);
+
+		if (!page)
+		{
+			break;
+		}
+
+		poolFree(page, POOL_BENCH);
+	}
+
+	report("Pip_AllocPage", count);
+
+	// Pip_CreatePartition
+	for (count = 0; count < BENCH_ITERATIONS; count++)
+	{
+		uint32_t pages[5], i;
+
+		for (i = 0; i < 5; i++)
+		{
+			pages[i] = (uint32_t) poolAllocZeroedPage();
+
+			if (!pages[i])
+			{
+				break;
+			}
+		}
+
+		if (i < 5)
+		{
+			poolRelease(BENCH_OWNER);
+			break;
+		}
+
+		uint64_t start = readCycles();
+		uint32_t ret   = Pip_CreatePartition(pages[0], pages[1],
+				pages[2], pages[3], pages[4]);
+		samples[count] = (uint32_t) (readCycles() - start);
+
+		if (!ret)
+		{
+			poolRelease(BENCH_OWNER);
+			break;
+		}
+
+		deletePartition(pages[0]);
+	}
+
+	report("Pip_CreatePartition", count);
+
+	// Pip_MapPageWrapper, into consecutive pages of one partition. The
+	// kernel structures are prepared from the pool up front, rather than
+	// allocated by libpip behind the pool accounts, so the samples time
+	// the Pip_CountToMap and Pip_AddVAddr calls of the wrapper
+	struct map_stats stats = { 0 };
+
+	descChild = createPartition();
+
+	if (descChild && prepareRange(descChild, BENCH_VADDR,
+			BENCH_ITERATIONS * PAGE_SIZE, &stats) != SUCCESS)
+	{
+		deletePartition(descChild);
+		descChild = 0;
+	}
+
+	for (count = 0; descChild && count < BENCH_ITERATIONS; count++)
+	{
+		uint32_t page = (uint32_t) poolAllocPage();
+
+		if (!page)
+		{
+			break;
+		}
+
+		uint64_t start = readCycles();
+		enum map_page_wrapper_ret_e ret = Pip_MapPageWrapper(page,
+				descChild, BENCH_VADDR + count * PAGE_SIZE);
+		samples[count] = (uint32_t) (readCycles() - start);
+
+		if (ret != SUCCESS)
+		{
+			break;
+		}
+	}
+
+	report("Pip_MapPageWrapper", count);
+
+	if (descChild)
+	{
+		deletePartition(descChild);
+	}
+
+	// Pip_AllocContext, whose contexts cannot be given back to libpip
+	user_ctx_t *context = 0;
+
+	for (count = 0; count < BENCH_ITERATIONS; count++)
+	{
+		uint64_t start = readCycles();
+		user_ctx_t *sample = Pip_AllocContext();
+		samples[count] = (uint32_t) (readCycles() - start);
+
+		if (!sample)
+		{
+			break;
+		}
+
+		context = sample;
+	}
+
+	report("Pip_AllocContext", count);
+
+	// Pip_RegisterInterrupt, on a vector no interrupt is raised on, with
+	// the last context sampled above
+	uint32_t stack = (uint32_t) poolAllocPage();
+
+	for (count = 0; context && stack && count < BENCH_ITERATIONS; count++)
+	{
+		uint64_t start = readCycles();
+		Pip_RegisterInterrupt(context, BENCH_VECTOR,
+				(uint32_t) benchHandler, stack, 0);
+		samples[count] = (uint32_t) (readCycles() - start);
+	}
+
+	report("Pip_RegisterInterrupt", count);
+
+	if (stack)
+	{
+		poolFree((uint32_t*) stack, POOL_BENCH);
+	}
+
+	poolSetCategory(category);
+	poolSetOwner(POOL_ROOT);
+}
+
+/*!
+ * \fn void benchYield(uint32_t descChild)
+ * \brief Benchmark a root to child to root round trip
+ * \param descChild The descriptor of a child built with LAUNCHER_BENCH,
+ *        which yields back to the root as soon as it is scheduled
+ */
+void benchYield(uint32_t descChild)
+{
+	uint32_t count;
+
+	for (count = 0; count < BENCH_ITERATIONS; count++)
+	{
+		uint64_t start = readCycles();
+		uint32_t ret   = Pip_Yield(descChild, 0, 49, 0, 0);
+		samples[count] = (uint32_t) (readCycles() - start);
+
+		if (ret)
+		{
+			printf("Pip_Yield returned 0x%x ...\n", ret);
+			break;
+		}
+	}
+
+	report("Pip_Yield-roundtrip", count);
+}
+
+/*!
+ * \fn void benchRing(uint32_t descChild, struct ring *toChild,
+ *		struct ring *toRoot)
+ * \brief Benchmark the channel to a child, each sample being the cycles per
+ *        message of a batch sent, echoed by the child and received back,
+ *        with a single yield round trip per batch
+ * \param descChild The descriptor of a child built with LAUNCHER_BENCH,
+ *        which echoes the messages before yielding back to the root
+ * \param toChild The root to child ring of the child
+ * \param toRoot The child to root ring of the child
+ * \note The batch of one message stands for a yield per message design.
+ */
+void benchRing(uint32_t descChild, struct ring *toChild, struct ring *toRoot)
+{
+	static const char *names[BENCH_RING_BATCHES] =
+	{
+		"ring-batch1", "ring-batch2", "ring-batch4", "ring-batch8",
+		"ring-batch16", "ring-batch32", "ring-batch64"
+	};
+
+	static struct ring_msg msgs[64];
+
+	for (uint32_t b = 0; b < BENCH_RING_BATCHES; b++)
+	{
+		uint32_t batch = 1 << b;
+		uint32_t count;
+
+		for (count = 0; count < BENCH_ITERATIONS; count++)
+		{
+			for (uint32_t i = 0; i < batch; i++)
+			{
+				msgs[i].type    = count;
+				msgs[i].args[0] = i;
+			}
+
+			uint64_t start = readCycles();
+			uint32_t sent  = ringPushBatch(toChild, msgs, batch);
+			uint32_t ret   = Pip_Yield(descChild, 0, 49, 0, 0);
+			uint32_t recv  = ringPopBatch(toRoot, msgs, batch);
+			uint64_t end   = readCycles();
+
+			if (ret || sent != batch || recv != batch)
+			{
+				printf("Channel round trip failed: yield 0x%x, "
+						"%d sent, %d received ...\n",
+						ret, sent, recv);
+				break;
+			}
+
+			samples[count] = averageCycles(end - start, batch);
+		}
+
+		report(names[b], count);
+	}
+}
+
+/*!
+ * \fn void benchFpu(void)
+ * \brief Benchmark the FPU state switch done before each yield, to an
+ *        integer-only child, to the child owning the FPU registers, and to
+ *        a child using the FPU which does not own them
+ */
+void benchFpu(void)
+{
+	static struct partition integer, first, second;
+	uint32_t count;
+
+	poolSetOwner(BENCH_OWNER);
+	first.fpuArea  = poolAllocZeroedPage();
+	second.fpuArea = poolAllocZeroedPage();
+	poolSetOwner(POOL_ROOT);
+
+	if (!first.fpuArea || !second.fpuArea)
+	{
+		printf("Failed to allocate the FPU save areas ...\n");
+		return;
+	}
+
+	fpuInitArea(first.fpuArea);
+	fpuInitArea(second.fpuArea);
+
+	for (count = 0; count < BENCH_ITERATIONS; count++)
+	{
+		uint64_t start = readCycles();
+		fpuSwitch(&integer);
+		samples[count] = (uint32_t) (readCycles() - start);
+	}
+
+	report("fpu-switch-integer", count);
+
+	for (count = 0; count < BENCH_ITERATIONS; count++)
+	{
+		fpuSwitch(&first);
+
+		uint64_t start = readCycles();
+		fpuSwitch(&first);
+		samples[count] = (uint32_t) (readCycles() - start);
+	}
+
+	report("fpu-switch-owner", count);
+
+	for (count = 0; count < BENCH_ITERATIONS; count++)
+	{
+		uint64_t start = readCycles();
+		fpuSwitch(count % 2 ? &first : &second);
+		samples[count] = (uint32_t) (readCycles() - start);
+	}
+
+	report("fpu-switch-state", count);
+
+	fpuForget(&first);
+	fpuForget(&second);
+	poolRelease(BENCH_OWNER);
+}
+
+/*!
+ * \fn static uint32_t bytesPerKilocycle(uint32_t bytes, uint32_t cycles)
+ * \brief Compute the rate of a transfer
+ * \param bytes The bytes transferred
+ * \param cycles The cycles the transfer took
+ * \return The bytes transferred per thousand cycles
+ */
+static uint32_t bytesPerKilocycle(uint32_t bytes, uint32_t cycles)
+{
+	return cycles ? averageCycles((uint64_t) bytes * 1000, cycles) : 0;
+}
+
+/*!
+ * \fn void benchGrant(struct partition *partition)
+ * \brief Benchmark the hand over of a run of pages to a child by page
+ *        grant against the copy of the run into as many other pages, for
+ *        runs of 4 KiB to 64 MiB, and print the smallest size from which
+ *        the grant is faster:
+ *
+ * BENCH grant-rate size=<bytes> remap=<bytes/kcycle> copy=<bytes/kcycle>
+ * BENCH grant-crossover size=<bytes>
+ *
+ * \param partition A bootstrapped child, which does not run meanwhile
+ * \note The page tables of the run are prepared by an untimed grant, and
+ *       each grant sample is followed by an untimed grant back to the root.
+ */
+void benchGrant(struct partition *partition)
+{
+	static const char *remapNames[BENCH_GRANT_SIZES] =
+	{
+		"grant-remap-4K", "grant-remap-16K", "grant-remap-64K",
+		"grant-remap-256K", "grant-remap-1M", "grant-remap-4M",
+		"grant-remap-16M", "grant-remap-64M"
+	};
+
+	static const char *copyNames[BENCH_GRANT_SIZES] =
+	{
+		"grant-copy-4K", "grant-copy-16K", "grant-copy-64K",
+		"grant-copy-256K", "grant-copy-1M", "grant-copy-4M",
+		"grant-copy-16M", "grant-copy-64M"
+	};
+
+	static uint32_t runPages[BENCH_GRANT_MAX_PAGES];
+	static uint32_t copyPages[BENCH_GRANT_MAX_PAGES];
+
+	uint32_t descChild = partition->descriptor;
+	uint32_t crossover = 0;
+	struct map_stats stats = { 0 };
+	struct grant run, copy;
+
+	poolSetOwner(BENCH_OWNER);
+
+	for (uint32_t s = 0; s < BENCH_GRANT_SIZES; s++)
+	{
+		uint32_t pages = 1 << (2 * s);
+		uint32_t bytes = pages * PAGE_SIZE;
+		uint32_t count, remap, copied;
+
+		if (!grantAlloc(&run, runPages, pages))
+		{
+			printf("No memory left for a run of %d bytes ...\n",
+					bytes);
+			break;
+		}
+
+		if (!grantAlloc(&copy, copyPages, pages))
+		{
+			printf("No memory left for a run of %d bytes ...\n",
+					bytes);
+			grantFree(&run, &stats);
+			break;
+		}
+
+		// Prepare the page tables of the run in the child
+		if (!grantMove(&run, descChild, BENCH_OWNER, BENCH_VADDR,
+				&stats) ||
+		    !grantMove(&run, GRANT_ROOT, BENCH_OWNER, 0, &stats))
+		{
+			printf("Failed to grant a run of %d bytes ...\n", bytes);
+			grantFree(&run, &stats);
+			grantFree(&copy, &stats);
+			break;
+		}
+
+		for (count = 0; count < BENCH_GRANT_ITERATIONS; count++)
+		{
+			uint64_t start = readCycles();
+			uint32_t ret   = grantMove(&run, descChild,
+					BENCH_OWNER, BENCH_VADDR, &stats);
+			samples[count] = (uint32_t) (readCycles() - start);
+
+			if (!ret || !grantMove(&run, GRANT_ROOT, BENCH_OWNER, 0,
+					&stats))
+			{
+				break;
+			}
+		}
+
+		report(remapNames[s], count);
+		remap = count ? samples[count / 2] : 0;
+
+		for (count = 0; count < BENCH_GRANT_ITERATIONS; count++)
+		{
+			uint64_t start = readCycles();
+
+			for (uint32_t i = 0; i < pages; i++)
+			{
+				copyPage(copyPages[i], runPages[i]);
+			}
+
+			samples[count] = (uint32_t) (readCycles() - start);
+		}
+
+		report(copyNames[s], count);
+		copied = samples[count / 2];
+
+		printf("BENCH grant-rate size=%d remap=%d copy=%d\n", bytes,
+				bytesPerKilocycle(bytes, remap),
+				bytesPerKilocycle(bytes, copied));
+
+		if (!crossover && remap && remap < copied)
+		{
+			crossover = bytes;
+		}
+
+		if (!grantFree(&run, &stats) || !grantFree(&copy, &stats))
+		{
+			printf("Failed to take a run of %d bytes back ...\n",
+					bytes);
+			PANIC();
+		}
+	}
+
+	if (crossover)
+	{
+		printf("BENCH grant-crossover size=%d\n", crossover);
+	}
+	else
+	{
+		printf("BENCH grant-crossover none\n");
+	}
+
+	poolSetOwner(POOL_ROOT);
+}
+
+/*!
+ * \fn void benchRestart(struct partition *partition)
+ * \brief Benchmark the restart of a child from its snapshot, with no page
+ *        to restore and with all its writable pages to restore
+ * \param partition A bootstrapped child, which is left restarted
+ */
+void benchRestart(struct partition *partition)
+{
+	struct snapshot *snapshot = partition->snapshot;
+	uint32_t count;
+
+	if (!snapshot)
+	{
+		printf("The child has no snapshot to restart from ...\n");
+		return;
+	}
+
+	// Restore the pages the child wrote since its bootstrap
+	snapshotRestore(partition);
+
+	for (count = 0; count < BENCH_ITERATIONS; count++)
+	{
+		uint64_t start = readCycles();
+		snapshotRestore(partition);
+		samples[count] = (uint32_t) (readCycles() - start);
+	}
+
+	report("restart-clean", count);
+
+	for (count = 0; count < BENCH_ITERATIONS; count++)
+	{
+		// Dirty the last word of every writable page
+		for (uint32_t i = 0; i < snapshot->count; i++)
+		{
+			((uint32_t*) snapshot->pages[i].page)[PAGE_SIZE /
+				sizeof(uint32_t) - 1] ^= 1;
+		}
+
+		uint64_t start = readCycles();
+		snapshotRestore(partition);
+		samples[count] = (uint32_t) (readCycles() - start);
+	}
+
+	report("restart-dirty", count);
+}
+
+/*!
+ * \fn void benchNesting(struct partition *partition, uint32_t depth)
+ * \brief Benchmark the yield round trip through a child, and the
+ *        forwarding of a vector down to the ping-pong peer through the
+ *        VIDT of the nested launchers in between
+ * \param partition A child built with LAUNCHER_BENCH, minimal.bin or a
+ *        nested launcher of minimal/nested.c
+ * \param depth The depth of the ping-pong peer below the root partition,
+ *        from 1 to BENCH_NESTING_DEPTHS
+ * \note Each nested launcher passes the yield down to its child with a
+ *       Pip_Yield, and forwards the vector from the handler it installed
+ *       in the slot of the vector, as the root forwards the timer.
+ */
+void benchNesting(struct partition *partition, uint32_t depth)
+{
+	static const char *yieldNames[BENCH_NESTING_DEPTHS] =
+	{
+		"nesting-yield-depth1", "nesting-yield-depth2",
+		"nesting-yield-depth3", "nesting-yield-depth4"
+	};
+
+	static const char *forwardNames[BENCH_NESTING_DEPTHS] =
+	{
+		"nesting-forward-depth1", "nesting-forward-depth2",
+		"nesting-forward-depth3", "nesting-forward-depth4"
+	};
+
+	uint32_t descChild = partition->descriptor;
+	uint32_t count, ret;
+
+	// The nested launchers bootstrap their child on their first run
+	ret = Pip_Yield(descChild, 0, 49, 0, 0);
+
+	if (ret)
+	{
+		printf("Pip_Yield returned 0x%x ...\n", ret);
+		return;
+	}
+
+	for (count = 0; count < BENCH_ITERATIONS; count++)
+	{
+		uint64_t start = readCycles();
+		ret            = Pip_Yield(descChild, 0, 49, 0, 0);
+		samples[count] = (uint32_t) (readCycles() - start);
+
+		if (ret)
+		{
+			printf("Pip_Yield returned 0x%x ...\n", ret);
+			break;
+		}
+	}
+
+	report(yieldNames[depth - 1], count);
+
+	// The child serving the vector yields back to the root context
+	VIDT[BENCH_FORWARD_SAVE_INDEX] = VIDT[49];
+
+	for (count = 0; count < BENCH_ITERATIONS; count++)
+	{
+		uint64_t start = readCycles();
+		ret            = Pip_Yield(descChild, BENCH_FORWARD_VECTOR,
+				BENCH_FORWARD_SAVE_INDEX, 0, 0);
+		samples[count] = (uint32_t) (readCycles() - start);
+
+		if (ret)
+		{
+			printf("Pip_Yield returned 0x%x ...\n", ret);
+			break;
+		}
+	}
+
+	report(forwardNames[depth - 1], count);
+}
@@ -0,0 +1,710 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the partition builder, which bootstraps child
+ * partitions from their images with the pages of the page pool, and yields
+ * to them. It holds no state of its own besides the builders it is given,
+ * so that the root partition and the nested launchers of minimal/nested.c
+ * link it from the libbuilder.a library.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/paging.h>
+#include <pip/vidt.h>
+#include <pip/api.h>
+#include <pip/wrappers.h>
+
+#include "launcher.h"
+#include "builder.h"
+#include "cycles.h"
+#include "fpu.h"
+#include "lazy.h"
+#include "lz4.h"
+#include "map.h"
+#include "partitions.h"
+#include "pool.h"
+#include "ring.h"
+#include "snapshot.h"
+
+/*
+ * Function prototypes
+ */
+static uint32_t bootstrapPartition(struct builder *builder,
+		struct partition *partition);
+static enum map_page_wrapper_ret_e mapImagePages(struct partition *partition,
+		uint32_t offset, uint32_t size, uint32_t flags);
+static enum map_page_wrapper_ret_e mapImage(struct builder *builder,
+		struct partition *partition);
+static void destroyPartition(struct builder *builder,
+		struct partition *partition);
+static void printImageSizes(struct partition *partition);
+static void printColors(struct builder *builder, struct partition *partition);
+
+/*!
+ * \fn void builderInit(struct builder *builder,
+ *		const struct builder_layout *layout,
+ *		struct partition *partitions, uint32_t capacity,
+ *		uint32_t flags)
+ * \brief Initialize a builder
+ * \param builder The builder to initialize
+ * \param layout The layout of the children
+ * \param partitions The partition slots, which must be zeroed
+ * \param capacity The number of partition slots
+ * \param flags The BUILDER_* flags
+ * \note The page pool must be initialized before launching children.
+ */
+void builderInit(struct builder *builder, const struct builder_layout *layout,
+		struct partition *partitions, uint32_t capacity,
+		uint32_t flags)
+{
+	builder->layout         = *layout;
+	builder->partitions     = partitions;
+	builder->capacity       = capacity;
+	builder->count          = 0;
+	builder->flags          = flags;
+	builder->sharingRefused = 0;
+}
+
+/*!
+ * \fn struct partition *builderLaunch(struct builder *builder,
+ *		const struct child_image *image)
+ * \brief Bootstrap a child partition from its image into the next partition
+ *        slot, and send it its index. A child that fails to bootstrap is
+ *        torn down and its slot is reused.
+ * \param builder The builder
+ * \param image The image of the child
+ * \return The child partition, 0 if it could not be bootstrapped
+ */
+struct partition *builderLaunch(struct builder *builder,
+		const struct child_image *image)
+{
+	uint32_t index = builder->count;
+
+	if (index == builder->capacity)
+	{
+		printf("No partition slot left for the child %s ...\n",
+				image->name);
+		return 0;
+	}
+
+	struct partition *partition = &builder->partitions[index];
+
+	partition->image = image;
+
+	// Bootstrap the child partition, its pages being attributed to it and
+	// taken from its cache colors
+	poolSetOwner(POOL_OWNER(index));
+	poolSetColors(image->colors);
+
+	if (builder->flags & BUILDER_SNAPSHOT)
+	{
+		snapshotBegin(partition);
+	}
+
+	uint64_t start = readCycles();
+	uint32_t ret   = bootstrapPartition(builder, partition);
+	partition->bootstrapCycles = (uint32_t) (readCycles() - start);
+
+	// Copy the pristine writable pages to restart the child from
+	if (builder->flags & BUILDER_SNAPSHOT)
+	{
+		snapshotEnd(partition, ret == 0);
+	}
+
+	poolSetOwner(POOL_ROOT);
+	poolSetCategory(POOL_OTHER);
+	poolSetColors(0);
+
+	switch (ret)
+	{
+		case 0:
+			printf("Child %d (%s) bootstrapped in %d cycles\n",
+					index, image->name,
+					partition->bootstrapCycles);
+			printMapStats(&partition->mapStats);
+			printImageSizes(partition);
+			printColors(builder, partition);
+			builderSendHello(partition, index);
+			builder->count++;
+			return partition;
+		case FAIL_CREATE_PARTITION:
+			printf("bootstrapPartition returned "
+					"FAIL_CREATE_PARTITION ...\n");
+			break;
+		case FAIL_MAP_CHILD_PAGE:
+			printf("bootstrapPartition returned "
+					"FAIL_MAP_CHILD_PAGE ...\n");
+			break;
+		case FAIL_MAP_STACK_PAGE:
+			printf("bootstrapPartition returned "
+					"FAIL_MAP_STACK_PAGE ...\n");
+			break;
+		case FAIL_MAP_VIDT_PAGE:
+			printf("bootstrapPartition returned "
+					"FAIL_MAP_VIDT_PAGE ...\n");
+			break;
+		case FAIL_DECOMPRESS_IMAGE:
+			printf("bootstrapPartition returned "
+					"FAIL_DECOMPRESS_IMAGE ...\n");
+			break;
+		case FAIL_MAP_CHANNEL_PAGE:
+			printf("bootstrapPartition returned "
+					"FAIL_MAP_CHANNEL_PAGE ...\n");
+			break;
+		case FAIL_ALLOC_FPU_AREA:
+			printf("bootstrapPartition returned "
+					"FAIL_ALLOC_FPU_AREA ...\n");
+			break;
+		default:
+			printf("bootstrapPartition returned "
+				"an unexpected value: %d ...\n", ret);
+	}
+
+	printf("Failed to bootstrap the child %d (%s) ...\n", index,
+			image->name);
+	destroyPartition(builder, partition);
+
+	return 0;
+}
+
+/*!
+ * \fn void builderSendHello(struct partition *partition, uint32_t index)
+ * \brief Send its index to a bootstrapped child through its channel
+ * \param partition The child partition
+ * \param index The index of the child
+ */
+void builderSendHello(struct partition *partition, uint32_t index)
+{
+	struct ring_msg msg = { CHANNEL_MSG_HELLO, { index, 0, 0 } };
+
+	ringPush(partition->toChild, &msg);
+}
+
+/*!
+ * \fn void builderYield(struct partition *partition)
+ * \brief Do the yield to a child partition and abort if an error occured.
+ * \param partition The child partition
+ * \note The caller is resumed when a child yields back to its VIDT slot 49.
+ */
+void builderYield(struct partition *partition)
+{
+	fpuSwitch(partition);
+
+	uint32_t ret = Pip_Yield(partition->descriptor, 0, 49, 0, 0);
+
+	switch (ret)
+	{
+		case 0: return;
+		case FAIL_INVALID_INT_LEVEL:
+			printf("Pip_Yield returned "
+					"FAIL_INVALID_INT_LEVEL ...\n");
+			break;
+		case FAIL_INVALID_CTX_SAVE_INDEX:
+			printf("Pip_Yield returned "
+					"FAIL_INVALID_CTX_SAVE_INDEX ...\n");
+			break;
+		case FAIL_ROOT_CALLER:
+			printf("Pip_Yield returned "
+					"FAIL_ROOT_CALLER ...\n");
+			break;
+		case FAIL_INVALID_CHILD:
+			printf("Pip_Yield returned "
+					"FAIL_INVALID_CHILD ...\n");
+			break;
+		case FAIL_UNAVAILABLE_TARGET_VIDT:
+			printf("Pip_Yield returned "
+					"FAIL_UNAVAILABLE_TARGET_VIDT ...\n");
+			break;
+		case FAIL_UNAVAILABLE_CALLER_VIDT:
+			printf("Pip_Yield returned "
+					"FAIL_UNAVAILABLE_CALLER_VIDT ...\n");
+			break;
+		case FAIL_MASKED_INTERRUPT:
+			printf("Pip_Yield returned "
+					"FAIL_MASKED_INTERRUPT ...\n");
+			break;
+		case FAIL_UNAVAILABLE_TARGET_CTX:
+			printf("Pip_Yield returned "
+					"FAIL_UNAVAILABLE_TARGET_CTX ...\n");
+			break;
+		case FAIL_CALLER_CONTEXT_SAVE:
+			printf("Pip_Yield returned "
+					"FAIL_CALLER_CONTEXT_SAVE ...\n");
+			break;
+		default:
+			printf("Pip_Yield returned an unexpected value: "
+					"0x%x ...\n", ret);
+	}
+
+	PANIC();
+}
+
+/*!
+ * \fn static uint32_t bootstrapPartition(struct builder *builder,
+ *		struct partition *partition)
+ * \brief Bootstraping a new child partition from its image
+ * \param builder The builder, giving the layout of the child
+ * \param partition The partition to bootstrap, its image field must be set
+ * \return 0 in the case of a success, greater than zero otherwise
+ */
+static uint32_t bootstrapPartition(struct builder *builder,
+		struct partition *partition)
+{
+	enum map_page_wrapper_ret_e map_page_rcode;
+
+	const struct builder_layout *layout = &builder->layout;
+
+	uint32_t loadAddress = partition->image->loadAddress;
+
+	if ((partition->image->flags & CHILD_LZ4) &&
+			!lz4ImageHeader(partition->image))
+	{
+		return FAIL_DECOMPRESS_IMAGE;
+	}
+
+	// Allocate 5 memory pages in order to create a child partition
+	poolSetCategory(POOL_PARTITION);
+
+	uint32_t descChild       = (uint32_t) poolAllocZeroedPage();
+	uint32_t pdChild         = (uint32_t) poolAllocZeroedPage();
+	uint32_t shadow1Child    = (uint32_t) poolAllocZeroedPage();
+	uint32_t shadow2Child    = (uint32_t) poolAllocZeroedPage();
+	uint32_t configPagesList = (uint32_t) poolAllocZeroedPage();
+
+	// Create the child partition
+	if (!descChild || !pdChild || !shadow1Child || !shadow2Child ||
+			!configPagesList ||
+			!Pip_CreatePartition(descChild, pdChild, shadow1Child,
+				shadow2Child, configPagesList))
+	{
+		return FAIL_CREATE_PARTITION;
+	}
+
+	partition->descriptor = descChild;
+
+	// Map the whole child image to the newly created partition
+	poolSetCategory(POOL_IMAGE);
+	map_page_rcode = mapImage(builder, partition);
+	switch (map_page_rcode) {
+		case FAIL_ALLOC_PAGE:
+			printf("mapRange failed while allocating a page\n");
+			return FAIL_MAP_CHILD_PAGE;
+		case FAIL_PREPARE:
+			printf("mapRange failed while trying to give pages to the kernel for memory data structures\n");
+			return FAIL_MAP_CHILD_PAGE;
+		case FAIL_ADD_VADDR:
+			printf("mapRange failed while trying to add a memory page to the child\n");
+			return FAIL_MAP_CHILD_PAGE;
+		case SUCCESS :
+			break;
+		default:
+			printf("Unknown mapRange return code\n");
+	}
+
+	// Allocate a page for the child's stack
+	poolSetCategory(POOL_STACK);
+
+	uint32_t stackPage = (uint32_t) poolAllocPage();
+
+	if (!stackPage)
+	{
+		return FAIL_MAP_STACK_PAGE;
+	}
+
+	// Compute the physical address of the child context
+	user_ctx_t *contextPAddr = (user_ctx_t*) (stackPage + PAGE_SIZE -
+			sizeof(user_ctx_t));
+
+	// Compute the virtual address of the child context
+	user_ctx_t *contextVAddr = (user_ctx_t*) (layout->stackVAddr +
+			PAGE_SIZE - sizeof(user_ctx_t));
+
+	// Create the child's context, its stack starting below it
+	builderInitContext(contextPAddr, loadAddress, (uint32_t) contextVAddr);
+
+	partition->context = contextPAddr;
+
+	// Map the stack page to the newly created partition, the kernel pages
+	// being taken from the pool rather than by Pip_MapPageWrapper
+	map_page_rcode = mapRange(descChild, stackPage, PAGE_SIZE,
+			layout->stackVAddr, MAP_WRITE, &partition->mapStats);
+        switch (map_page_rcode) {
+                case FAIL_ALLOC_PAGE:
+                        printf("mapRange failed while allocating a page\n");
+                        return FAIL_MAP_STACK_PAGE;
+                case FAIL_PREPARE:
+                        printf("mapRange failed while trying to give pages to the kernel for memory data structures\n");
+                        return FAIL_MAP_STACK_PAGE;
+                case FAIL_ADD_VADDR:
+                        printf("mapRange failed while trying to add a memory page to the child\n");
+                        return FAIL_MAP_STACK_PAGE;
+                case SUCCESS :
+                        break;
+                default:
+                        printf("Unknown mapRange return code\n");
+        }
+
+	// Allocate a memory page for the child's VIDT
+	poolSetCategory(POOL_VIDT);
+
+	user_ctx_t **vidtPage = (user_ctx_t**) poolAllocZeroedPage();
+
+	if (!vidtPage)
+	{
+		return FAIL_MAP_VIDT_PAGE;
+	}
+
+	// Save the child's context into the child's VIDT
+	vidtPage[ 0] = contextVAddr;
+	vidtPage[48] = contextVAddr;
+	vidtPage[49] = contextVAddr;
+
+	// Resume the child on the delegated timer interrupts, the child may
+	// install its own handler in this slot
+	if (partition->image->flags & CHILD_TIMER)
+	{
+		vidtPage[TIMER_VECTOR] = contextVAddr;
+	}
+
+	// Map the VIDT page to the newly created partition
+	map_page_rcode = mapRange(descChild, (uint32_t) vidtPage, PAGE_SIZE,
+			VIDT_VADDR, MAP_WRITE, &partition->mapStats);
+        switch (map_page_rcode) {
+                case FAIL_ALLOC_PAGE:
+                        printf("mapRange failed while allocating a page\n");
+                        return FAIL_MAP_VIDT_PAGE;
+                case FAIL_PREPARE:
+                        printf("mapRange failed while trying to give pages to the kernel for memory data structures\n");
+                        return FAIL_MAP_VIDT_PAGE;
+                case FAIL_ADD_VADDR:
+                        printf("mapRange failed while trying to add a memory page to the child\n");
+                        return FAIL_MAP_VIDT_PAGE;
+                case SUCCESS :
+                        break;
+                default:
+                        printf("Unknown mapRange return code\n");
+        }
+
+	// Allocate and map the channel pages, shared with the child
+	uint32_t channelPages[CHANNEL_PAGES];
+
+	poolSetCategory(POOL_CHANNEL);
+
+	for (uint32_t i = 0; i < CHANNEL_PAGES; i++)
+	{
+		channelPages[i] = (uint32_t) poolAllocZeroedPage();
+
+		if (!channelPages[i])
+		{
+			return FAIL_MAP_CHANNEL_PAGE;
+		}
+
+		if (mapRange(descChild, channelPages[i], PAGE_SIZE,
+				layout->channelVAddr + i * PAGE_SIZE, MAP_WRITE,
+				&partition->mapStats) != SUCCESS)
+		{
+			printf("mapRange failed while mapping a "
+					"channel page\n");
+			return FAIL_MAP_CHANNEL_PAGE;
+		}
+	}
+
+	partition->toChild = (struct ring*) channelPages[0];
+	partition->toRoot  = (struct ring*) channelPages[1];
+	partition->console = (struct console*) channelPages[2];
+
+	ringInit(partition->toChild);
+	ringInit(partition->toRoot);
+	consoleInit(partition->console);
+
+	// Allocate the FPU save area of a child using the FPU
+	if (partition->image->flags & CHILD_FPU)
+	{
+		poolSetCategory(POOL_OTHER);
+		partition->fpuArea = poolAllocZeroedPage();
+
+		if (!partition->fpuArea)
+		{
+			return FAIL_ALLOC_FPU_AREA;
+		}
+
+		fpuInitArea(partition->fpuArea);
+	}
+
+	return 0;
+}
+
+/*!
+ * \fn static enum map_page_wrapper_ret_e mapImagePages(
+ *		struct partition *partition, uint32_t offset, uint32_t size,
+ *		uint32_t flags)
+ * \brief Map pages of the image of a child partition
+ * \param partition The partition being bootstrapped
+ * \param offset The page-aligned offset of the first page in the image
+ * \param size The size of the pages to map
+ * \param flags The MAP_* flags of the mapping
+ * \return The same codes as Pip_MapPageWrapper
+ */
+static enum map_page_wrapper_ret_e mapImagePages(struct partition *partition,
+		uint32_t offset, uint32_t size, uint32_t flags)
+{
+	const struct child_image *image = partition->image;
+
+	// Compressed pages are decompressed into newly allocated pages
+	if (image->flags & CHILD_LZ4)
+	{
+		return lz4MapPages(partition, offset, size, flags);
+	}
+
+	return mapRange(partition->descriptor, image->start + offset, size,
+			image->loadAddress + offset, flags,
+			&partition->mapStats);
+}
+
+/*!
+ * \fn static enum map_page_wrapper_ret_e mapImage(
+ *		struct builder *builder, struct partition *partition)
+ * \brief Map the image of a child partition and its bss
+ * \param builder The builder
+ * \param partition The partition being bootstrapped
+ * \return The same codes as Pip_MapPageWrapper
+ * \note The first instance of an image is mapped in place. The next ones
+ *        get private copies of the writable pages, and of the read-only
+ *        pages unless the kernel accepts to map them in several children.
+ *        The embedded image is still pristine when they are copied, as no
+ *        child runs before all of them are bootstrapped. A compressed image
+ *        is decompressed into new pages for every instance. The pages
+ *        of an unaligned boot module are always copied.
+ */
+static enum map_page_wrapper_ret_e mapImage(struct builder *builder,
+		struct partition *partition)
+{
+	enum map_page_wrapper_ret_e rcode;
+
+	const struct child_image *image = partition->image;
+	const struct image_layout *layout;
+	struct map_stats *stats = &partition->mapStats;
+
+	uint32_t size;
+	uint32_t contentSize;
+	uint32_t firstInstance = 1;
+
+	for (struct partition *other = builder->partitions; other != partition;
+			other++)
+	{
+		if (other->image->start == image->start)
+		{
+			firstInstance = 0;
+			break;
+		}
+	}
+
+	if (image->flags & CHILD_LZ4)
+	{
+		const struct lz4_image_header *header = lz4ImageHeader(image);
+
+		contentSize = header->imageSize;
+		size        = (contentSize + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+		layout      = &header->layout;
+	}
+	else
+	{
+		contentSize = image->imageEnd - image->start;
+		size        = image->end - image->start;
+		layout      = (const struct image_layout*)
+			(image->imageEnd - sizeof(struct image_layout));
+	}
+
+	// An unaligned image cannot be mapped in place
+	uint32_t inPlace    = firstInstance && !(image->flags & CHILD_UNALIGNED);
+	uint32_t writeFlags = MAP_WRITE | (inPlace ? 0 : MAP_COPY);
+
+	// An image without layout footer is mapped writable as a whole
+	if (contentSize < sizeof(struct image_layout) ||
+			layout->magic != IMAGE_LAYOUT_MAGIC ||
+			layout->readOnlySize > size)
+	{
+		return mapImagePages(partition, 0, size, writeFlags);
+	}
+
+	uint32_t readOnlySize = layout->readOnlySize;
+	uint32_t readOnlyFlags = 0;
+
+	if (image->flags & CHILD_UNALIGNED)
+	{
+		readOnlyFlags = MAP_COPY;
+	}
+	else if (!firstInstance)
+	{
+		readOnlyFlags = builder->sharingRefused ? MAP_COPY : MAP_SHARE;
+	}
+
+	uint32_t copiedPages = stats->copiedPages;
+
+	// Map the text and rodata pages read-only, on demand for lazy children
+	if ((image->flags & (CHILD_LAZY | CHILD_LZ4)) == CHILD_LAZY)
+	{
+		rcode = lazyMapReadOnly(partition, readOnlySize, readOnlyFlags);
+	}
+	else
+	{
+		rcode = mapImagePages(partition, 0, readOnlySize,
+				readOnlyFlags);
+	}
+
+	if (rcode != SUCCESS)
+	{
+		return rcode;
+	}
+
+	// Stop trying to share pages once the kernel has refused it
+	if (readOnlyFlags == MAP_SHARE && stats->copiedPages != copiedPages)
+	{
+		builder->sharingRefused = 1;
+	}
+
+	// Map the data pages, up to the layout footer
+	rcode = mapImagePages(partition, readOnlySize, size - readOnlySize,
+			writeFlags);
+
+	if (rcode != SUCCESS)
+	{
+		return rcode;
+	}
+
+	// Map zeroed pages for the bss, right after the image
+	uint32_t bssSize = (layout->bssSize + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+
+	return mapRange(partition->descriptor, 0, bssSize,
+			image->loadAddress + size, MAP_WRITE | MAP_ZERO, stats);
+}
+
+/*!
+ * \fn static void destroyPartition(struct builder *builder,
+ *		struct partition *partition)
+ * \brief Tear down a child partition and return all its pages to the pool
+ * \param builder The builder
+ * \param partition The partition to tear down
+ * \note The partition slot is cleared and can be reused
+ */
+static void destroyPartition(struct builder *builder,
+		struct partition *partition)
+{
+	uint32_t index = partition - builder->partitions;
+
+	if (partition->descriptor &&
+			!Pip_DeletePartition(partition->descriptor))
+	{
+		printf("Pip_DeletePartition failed, the pages of the child %d "
+				"cannot be recycled ...\n", index);
+		PANIC();
+	}
+
+	fpuForget(partition);
+
+	uint32_t released = poolRelease(POOL_OWNER(index));
+
+	printf("Child %d torn down, %d pages returned to the pool\n",
+			index, released);
+
+	// Clear the partition slot
+	uint32_t *words = (uint32_t*) partition;
+
+	for (uint32_t i = 0; i < sizeof(struct partition) / sizeof(uint32_t); i++)
+	{
+		words[i] = 0;
+	}
+}
+
+/*!
+ * \fn static void printImageSizes(struct partition *partition)
+ * \brief Print the size of the image embedded for a child partition and,
+ *        for a compressed image, the size it would have uncompressed
+ * \param partition A bootstrapped partition
+ */
+static void printImageSizes(struct partition *partition)
+{
+	const struct child_image *image = partition->image;
+	uint32_t embeddedSize = image->end - image->start;
+
+	if (!(image->flags & CHILD_LZ4))
+	{
+		printf("Embedded image ... %d bytes\n", embeddedSize);
+		return;
+	}
+
+	uint32_t imageSize = lz4ImageHeader(image)->imageSize;
+	uint32_t rawSize   = (imageSize + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+
+	printf("Embedded image ... %d bytes compressed, %d bytes raw "
+			"(%d bytes saved)\n", embeddedSize, rawSize,
+			rawSize - embeddedSize);
+}
+
+/*!
+ * \fn static void printColors(struct builder *builder,
+ *		struct partition *partition)
+ * \brief Print the cache colors of a bootstrapped child partition, and
+ *        warn when they are not disjoint from the colors of the previous
+ *        children
+ * \param builder The builder
+ * \param partition A bootstrapped partition
+ */
+static void printColors(struct builder *builder, struct partition *partition)
+{
+	uint32_t colors = partition->image->colors;
+	uint32_t shared = 0;
+
+	if (!colors)
+	{
+		return;
+	}
+
+	for (struct partition *other = builder->partitions; other != partition;
+			other++)
+	{
+		shared |= colors & other->image->colors;
+	}
+
+	printf("Cache colors ... 0x%x\n", colors);
+
+	if (shared)
+	{
+		printf("Cache colors 0x%x shared with another child ...\n",
+				shared);
+	}
+}
@@ -0,0 +1,211 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the cache coloring benchmark children. The probe
+ * measures the latency of its memory accesses over a working set fitting
+ * its share of the last-level cache, the noisy neighbour sweeps a buffer
+ * larger than the cache. Built with COLORBENCH_NOISY, this file makes the
+ * noisy neighbour.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+
+#include "console.h"
+#include "cycles.h"
+#include "ring.h"
+
+/*!
+ * \def LINE_WORDS
+ * \brief The number of words of a cache line
+ */
+#define LINE_WORDS	16
+
+#ifdef COLORBENCH_NOISY
+
+/*!
+ * \def NOISY_BYTES
+ * \brief The size of the buffer swept by the noisy neighbour
+ */
+#define NOISY_BYTES	(4 << 20)
+
+/*!
+ * \brief The buffer swept by the noisy neighbour
+ */
+static uint32_t buffer[NOISY_BYTES / sizeof(uint32_t)];
+
+#else
+
+/*!
+ * \def PROBE_BYTES
+ * \brief The working set of the probe, half of its share of a 2 MiB cache
+ *        given half of the colors
+ */
+#define PROBE_BYTES	(512 << 10)
+
+/*!
+ * \def PROBE_LINES
+ * \brief The number of cache lines of the working set of the probe
+ */
+#define PROBE_LINES	(PROBE_BYTES / (LINE_WORDS * sizeof(uint32_t)))
+
+/*!
+ * \def PROBE_PASSES
+ * \brief The number of passes over the working set between two reports
+ */
+#define PROBE_PASSES	64
+
+/*!
+ * \brief The working set of the probe, each line holding the index of the
+ *        next line to access in its first word
+ */
+static uint32_t buffer[PROBE_BYTES / sizeof(uint32_t)];
+
+/*!
+ * \brief The last line reached, keeping the accesses from being optimized
+ *        out
+ */
+static volatile uint32_t sink;
+
+/*!
+ * \fn static void buildChain(void)
+ * \brief Link the lines of the working set in a random cycle, defeating
+ *        the hardware prefetchers
+ * \note Sattolo's shuffle makes a single cycle through all the lines.
+ */
+static void buildChain(void)
+{
+	uint32_t random = 0x2545f491;
+
+	for (uint32_t i = 0; i < PROBE_LINES; i++)
+	{
+		buffer[i * LINE_WORDS] = i;
+	}
+
+	for (uint32_t i = PROBE_LINES - 1; i > 0; i--)
+	{
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+
+		uint32_t j    = random % i;
+		uint32_t next = buffer[i * LINE_WORDS];
+
+		buffer[i * LINE_WORDS] = buffer[j * LINE_WORDS];
+		buffer[j * LINE_WORDS] = next;
+	}
+}
+
+/*!
+ * \fn static uint32_t walkChain(void)
+ * \brief Access every line of the working set once
+ * \return The cycles spent
+ */
+static uint32_t walkChain(void)
+{
+	uint32_t line = 0;
+
+	uint64_t start = readCycles();
+
+	for (uint32_t i = 0; i < PROBE_LINES; i++)
+	{
+		line = buffer[line * LINE_WORDS];
+	}
+
+	uint64_t end = readCycles();
+
+	sink = line;
+
+	return (uint32_t) (end - start);
+}
+
+#endif
+
+/*!
+ * \fn void _main(void)
+ * \brief The child partition entry point called by the boot.S file
+ * \warning Do not name the entry point "main" because gcc generates an
+ *          erroneous machine code: it tries to retrieve the arguments argc
+ *          and argv even with the parameters --freestanding and -nostdlib
+ */
+void _main(void)
+{
+#ifdef COLORBENCH_NOISY
+	CONSOLE_PRINTF(CHANNEL_CONSOLE, "NOISY sweeping %d KiB\n",
+			NOISY_BYTES >> 10);
+
+	for (;;)
+	{
+		for (uint32_t i = 0; i < NOISY_BYTES / sizeof(uint32_t);
+				i += LINE_WORDS)
+		{
+			buffer[i]++;
+		}
+
+		CHANNEL_CONSOLE->work++;
+	}
+#else
+	CONSOLE_PRINTF(CHANNEL_CONSOLE, "PROBE walking %d KiB\n",
+			PROBE_BYTES >> 10);
+
+	buildChain();
+
+	for (;;)
+	{
+		uint64_t total = 0;
+		uint32_t best  = ~0U;
+
+		for (uint32_t pass = 0; pass < PROBE_PASSES; pass++)
+		{
+			uint32_t cycles = walkChain();
+
+			total += cycles;
+
+			if (cycles < best)
+			{
+				best = cycles;
+			}
+
+			CHANNEL_CONSOLE->work++;
+		}
+
+		CONSOLE_PRINTF(CHANNEL_CONSOLE, "PROBE cycles per access "
+				"avg=%d min=%d\n",
+				averageCycles(total, PROBE_PASSES * PROBE_LINES),
+				best / PROBE_LINES);
+	}
+#endif
+}
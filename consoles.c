@@ -0,0 +1,182 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the draining of the buffered consoles: the root
+ * partition writes the messages of its own console and of the consoles of
+ * the child partitions to the serial port, a bounded number of bytes at a
+ * time, and accounts the work the children report through their console.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+
+#include "consoles.h"
+#include "cycles.h"
+
+/*!
+ * \brief The console of the root partition
+ */
+struct console rootConsole;
+
+/*!
+ * \brief The console drained first by the next drain, the root console
+ *        being the last one
+ */
+static uint32_t nextConsole;
+
+/*!
+ * \fn static uint32_t consoleDrain(struct console *console, uint32_t budget)
+ * \brief Write the messages of a console to the serial port
+ * \param console The console
+ * \param budget The maximum number of bytes written
+ * \return The number of bytes written
+ */
+static uint32_t consoleDrain(struct console *console, uint32_t budget)
+{
+	char chunk[CONSOLE_LINE + 1];
+	uint32_t drained = 0;
+
+	while (drained < budget)
+	{
+		uint32_t head  = console->head;
+		uint32_t count = console->tail - head;
+
+		if (!count)
+		{
+			break;
+		}
+
+		if (count > CONSOLE_LINE)
+		{
+			count = CONSOLE_LINE;
+		}
+
+		if (count > budget - drained)
+		{
+			count = budget - drained;
+		}
+
+		RING_BARRIER();
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			chunk[i] = console->data[(head + i) & (CONSOLE_BYTES - 1)];
+		}
+
+		chunk[count] = '\0';
+
+		RING_BARRIER();
+		console->head = head + count;
+
+		printf("%s", chunk);
+		drained += count;
+	}
+
+	return drained;
+}
+
+/*!
+ * \fn void consolesDrain(struct partition *partitions, uint32_t count)
+ * \brief Write the messages of the consoles to the serial port, up to
+ *        CONSOLE_DRAIN_BUDGET bytes, starting with a different child each
+ *        time so that a chatty child does not starve the others
+ * \param partitions The child partitions
+ * \param count The number of child partitions
+ */
+void consolesDrain(struct partition *partitions, uint32_t count)
+{
+	uint32_t budget = CONSOLE_DRAIN_BUDGET;
+
+	for (uint32_t i = 0; i <= count && budget; i++)
+	{
+		uint32_t index = (nextConsole + i) % (count + 1);
+
+		if (index == count)
+		{
+			budget -= consoleDrain(&rootConsole, budget);
+			continue;
+		}
+
+		uint32_t drained = consoleDrain(partitions[index].console,
+				budget);
+
+		partitions[index].consoleBytes += drained;
+		budget -= drained;
+	}
+
+	nextConsole = (nextConsole + 1) % (count + 1);
+}
+
+/*!
+ * \fn void consoleEndSlice(struct partition *partition, uint32_t index)
+ * \brief Account the work a child reported during the time slice it ends,
+ *        and print its console counters every CONSOLE_STATS_PERIOD slices
+ * \param partition The child partition
+ * \param index The index of the child
+ */
+void consoleEndSlice(struct partition *partition, uint32_t index)
+{
+	uint32_t work = partition->console->work;
+
+	partition->sliceWork  += work - partition->consoleWork;
+	partition->consoleWork = work;
+	partition->slices++;
+
+	if (partition->slices % CONSOLE_STATS_PERIOD == 0)
+	{
+		printConsoleStats(partition, index);
+	}
+}
+
+/*!
+ * \fn void printConsoleStats(struct partition *partition, uint32_t index)
+ * \brief Print the console counters of a child, once it ended a time slice
+ * \param partition The child partition
+ * \param index The index of the child
+ */
+void printConsoleStats(struct partition *partition, uint32_t index)
+{
+	if (!partition->slices)
+	{
+		return;
+	}
+
+	CONSOLE_PRINTF(&rootConsole, "Console of the child %d (%s) ... "
+			"%d bytes, %d dropped, %d work units per slice\n",
+			index, partition->image->name,
+			partition->consoleBytes, partition->console->dropped,
+			averageCycles(partition->sliceWork, partition->slices));
+}
@@ -0,0 +1,165 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the lazy FPU state switching of the root partition.
+ * The FPU and SSE registers hold the state of a single child, their owner.
+ * Before yielding to a child using the FPU, the root partition saves the
+ * state of the owner into its save area and restores the state of the child,
+ * unless the child already owns the registers. Integer-only children leave
+ * the registers untouched, and the switches to them cost a flag test.
+ *
+ * The root partition runs in ring 3 and cannot set CR0.TS, so the first use
+ * of the FPU by a child cannot be trapped: a child using it is declared by
+ * the "fpu" option of the manifest.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/paging.h>
+
+#include "cycles.h"
+#include "fpu.h"
+
+/*!
+ * \brief The child whose state is held by the FPU registers
+ */
+static struct partition *fpuOwner;
+
+/*!
+ * \brief The FPU switch counters
+ */
+static struct fpu_stats fpuStats;
+
+/*!
+ * \brief The number of switches when the counters were last printed
+ */
+static uint32_t printedSwitches;
+
+/*!
+ * \fn void fpuInitArea(uint32_t *area)
+ * \brief Initialize a zeroed save area to the state set by fninit, with the
+ *        SSE exceptions masked
+ * \param area The save area, 16-byte aligned
+ */
+void fpuInitArea(uint32_t *area)
+{
+	area[0] = FPU_FCW_DEFAULT;
+	area[FPU_MXCSR_OFFSET / sizeof(uint32_t)] = FPU_MXCSR_DEFAULT;
+}
+
+/*!
+ * \fn void fpuSwitch(struct partition *next)
+ * \brief Switch the FPU state before yielding to a child
+ * \param next The child the root partition yields to
+ */
+void fpuSwitch(struct partition *next)
+{
+	uint64_t start = readCycles();
+
+	if (!next->fpuArea)
+	{
+		fpuStats.integerSwitches++;
+		fpuStats.integerCycles += readCycles() - start;
+		return;
+	}
+
+	if (fpuOwner == next)
+	{
+		fpuStats.ownerSwitches++;
+		fpuStats.ownerCycles += readCycles() - start;
+		return;
+	}
+
+	if (fpuOwner)
+	{
+		__asm__ volatile ("fxsave (%0)" :: "r" (fpuOwner->fpuArea)
+				: "memory");
+	}
+
+	__asm__ volatile ("fxrstor (%0)" :: "r" (next->fpuArea) : "memory");
+
+	fpuOwner = next;
+
+	fpuStats.stateSwitches++;
+	fpuStats.stateCycles += readCycles() - start;
+}
+
+/*!
+ * \fn void fpuForget(struct partition *partition)
+ * \brief Drop the FPU state of a child being torn down
+ * \param partition The child
+ */
+void fpuForget(struct partition *partition)
+{
+	if (fpuOwner == partition)
+	{
+		fpuOwner = 0;
+	}
+}
+
+/*!
+ * \fn void printFpuStats(void)
+ * \brief Print the FPU switch counters if switches were done since the last
+ *        time they were printed
+ */
+void printFpuStats(void)
+{
+	uint32_t switches = fpuStats.integerSwitches + fpuStats.ownerSwitches +
+		fpuStats.stateSwitches;
+
+	if (switches == printedSwitches)
+	{
+		return;
+	}
+
+	printedSwitches = switches;
+
+	printf("FPU switches ... %d integer (average %d cycles), "
+			"%d owner (average %d cycles), "
+			"%d state (average %d cycles)\n",
+			fpuStats.integerSwitches,
+			fpuStats.integerSwitches ? averageCycles(
+				fpuStats.integerCycles,
+				fpuStats.integerSwitches) : 0,
+			fpuStats.ownerSwitches,
+			fpuStats.ownerSwitches ? averageCycles(
+				fpuStats.ownerCycles,
+				fpuStats.ownerSwitches) : 0,
+			fpuStats.stateSwitches,
+			fpuStats.stateSwitches ? averageCycles(
+				fpuStats.stateCycles,
+				fpuStats.stateSwitches) : 0);
+}
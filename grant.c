@@ -0,0 +1,257 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the page grants of the root partition. A run of pages
+ * is allocated from the pool, then handed from a partition to another: the
+ * pages are removed from the child holding them with Pip_RemoveVAddr, which
+ * gives them back to the root, and added at the agreed address of the next
+ * child with Pip_AddVAddr, the page tables of the range being prepared up
+ * front as mapRange does. No byte of the run is copied, and the pool
+ * accounts the pages to their holder.
+ *
+ * The root keeps seeing the pages it granted, as the parent of the children
+ * holding them, but does not touch them until they are granted back.
+ */
+
+#include <stdint.h>
+
+#include <pip/paging.h>
+#include <pip/api.h>
+#include <pip/wrappers.h>
+
+#include "grant.h"
+#include "map.h"
+#include "pool.h"
+
+static uint32_t addRun(uint32_t descChild, uint32_t vaddr,
+		const uint32_t *pages, uint32_t count, struct map_stats *stats);
+
+/*!
+ * \fn static uint32_t removeRun(uint32_t descChild, uint32_t vaddr,
+ *		const uint32_t *pages, uint32_t count, struct map_stats *stats)
+ * \brief Remove the pages of a run from a child
+ * \param descChild The child partition descriptor
+ * \param vaddr The address of the run in the child
+ * \param pages The root addresses of the pages
+ * \param count The number of pages
+ * \param stats The counters to update
+ * \return 1 in the case of a success, 0 otherwise, the pages removed being
+ *         added back
+ */
+static uint32_t removeRun(uint32_t descChild, uint32_t vaddr,
+		const uint32_t *pages, uint32_t count, struct map_stats *stats)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		stats->kernelCalls++;
+
+		if (!Pip_RemoveVAddr(descChild, vaddr + i * PAGE_SIZE))
+		{
+			addRun(descChild, vaddr, pages, i, stats);
+			return 0;
+		}
+
+		stats->mappedPages--;
+	}
+
+	return 1;
+}
+
+/*!
+ * \fn static uint32_t addRun(uint32_t descChild, uint32_t vaddr,
+ *		const uint32_t *pages, uint32_t count, struct map_stats *stats)
+ * \brief Add the pages of a run to a child whose page tables are prepared
+ * \param descChild The child partition descriptor
+ * \param vaddr The address of the run in the child
+ * \param pages The root addresses of the pages
+ * \param count The number of pages
+ * \param stats The counters to update
+ * \return 1 in the case of a success, 0 otherwise, the pages added being
+ *         removed again
+ */
+static uint32_t addRun(uint32_t descChild, uint32_t vaddr,
+		const uint32_t *pages, uint32_t count, struct map_stats *stats)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		stats->kernelCalls++;
+
+		if (!Pip_AddVAddr(pages[i], descChild, vaddr + i * PAGE_SIZE,
+				1, 1, 0))
+		{
+			removeRun(descChild, vaddr, pages, i, stats);
+			return 0;
+		}
+
+		stats->mappedPages++;
+	}
+
+	return 1;
+}
+
+/*!
+ * \fn static void transferRun(struct grant *grant, uint32_t owner)
+ * \brief Account the pages of a run to another owner of the pool
+ * \param grant The run
+ * \param owner The new owner
+ */
+static void transferRun(struct grant *grant, uint32_t owner)
+{
+	for (uint32_t i = 0; i < grant->count; i++)
+	{
+		poolTransfer((uint32_t*) grant->pages[i], POOL_GRANT, owner);
+	}
+}
+
+/*!
+ * \fn uint32_t grantAlloc(struct grant *grant, uint32_t *pages,
+ *		uint32_t count)
+ * \brief Allocate a run of zeroed pages, held by the root partition
+ * \param grant The run to fill
+ * \param pages The array receiving the root addresses of the pages
+ * \param count The number of pages
+ * \return 1 in the case of a success, 0 otherwise
+ * \note The pages are zeroed as they may be granted to a child.
+ */
+uint32_t grantAlloc(struct grant *grant, uint32_t *pages, uint32_t count)
+{
+	uint32_t category = poolSetCategory(POOL_GRANT);
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+	{
+		pages[i] = (uint32_t) poolAllocZeroedPage();
+
+		if (!pages[i])
+		{
+			break;
+		}
+	}
+
+	poolSetCategory(category);
+
+	if (i < count)
+	{
+		while (i > 0)
+		{
+			poolFree((uint32_t*) pages[--i], POOL_GRANT);
+		}
+
+		return 0;
+	}
+
+	grant->pages  = pages;
+	grant->count  = count;
+	grant->holder = GRANT_ROOT;
+	grant->vaddr  = 0;
+
+	return 1;
+}
+
+/*!
+ * \fn uint32_t grantMove(struct grant *grant, uint32_t descChild,
+ *		uint32_t owner, uint32_t vaddr, struct map_stats *stats)
+ * \brief Hand a run of pages to another partition
+ * \param grant The run
+ * \param descChild The descriptor of the child receiving the run, or
+ *        GRANT_ROOT for the root partition
+ * \param owner The pool owner of the receiver, POOL_ROOT or POOL_OWNER(index)
+ * \param vaddr The address of the run in the child receiving it, ignored
+ *        for the root partition
+ * \param stats The counters to update
+ * \return 1 in the case of a success, 0 otherwise
+ * \note The run is held by the root partition when it could be removed from
+ *       its holder but not added to the receiver, and left with its holder
+ *       when it could not be removed.
+ */
+uint32_t grantMove(struct grant *grant, uint32_t descChild, uint32_t owner,
+		uint32_t vaddr, struct map_stats *stats)
+{
+	if (grant->holder != GRANT_ROOT)
+	{
+		if (!removeRun(grant->holder, grant->vaddr, grant->pages,
+				grant->count, stats))
+		{
+			return 0;
+		}
+
+		grant->holder = GRANT_ROOT;
+		grant->vaddr  = 0;
+	}
+
+	if (descChild != GRANT_ROOT)
+	{
+		if (prepareRange(descChild, vaddr, grant->count * PAGE_SIZE,
+				stats) != SUCCESS ||
+		    !addRun(descChild, vaddr, grant->pages, grant->count,
+				stats))
+		{
+			transferRun(grant, POOL_ROOT);
+			return 0;
+		}
+
+		grant->holder = descChild;
+		grant->vaddr  = vaddr;
+	}
+
+	transferRun(grant, owner);
+
+	return 1;
+}
+
+/*!
+ * \fn uint32_t grantFree(struct grant *grant, struct map_stats *stats)
+ * \brief Return the pages of a run to the pool
+ * \param grant The run, taken back from the child holding it first
+ * \param stats The counters to update
+ * \return 1 in the case of a success, 0 when the run could not be taken back
+ */
+uint32_t grantFree(struct grant *grant, struct map_stats *stats)
+{
+	if (grant->holder != GRANT_ROOT &&
+	    !grantMove(grant, GRANT_ROOT, POOL_ROOT, 0, stats))
+	{
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < grant->count; i++)
+	{
+		poolFree((uint32_t*) grant->pages[i], POOL_GRANT);
+	}
+
+	grant->count = 0;
+
+	return 1;
+}
@@ -0,0 +1,241 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the idle loop and the tickless timer of the root
+ * partition. A child with no work left yields to the CHANNEL_IDLE_VECTOR of
+ * the root, which only resumes it on the next timer or keyboard interrupt.
+ * When no child has work, the root runs its background work, then waits in
+ * the idle loop for the next interrupt, which abandons the loop as every
+ * interrupt enters the root through its own context.
+ *
+ * The root runs in ring 3 and cannot halt the processor: the idle loop spins
+ * on the pause instruction, and its cycles are counted apart from the busy
+ * ones. The timer only ticks periodically when several children have work
+ * to share the processor, it otherwise interrupts once, after the longest
+ * count of the channel 0, and is armed again when it expired. The busy
+ * cycles and the wakeups per second are printed on keyboard interrupts:
+ *
+ * IDLE busy=<percent> wakeups=<per second> idle-wakeups=<per second> ...
+ *
+ * The seconds are those of the expired timer periods, whose counts are known.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/api.h>
+
+#include "launcher.h"
+#include "cycles.h"
+#include "idle.h"
+
+/*!
+ * \brief The programming of the timer
+ */
+static enum idle_timer timerMode = IDLE_TIMER_UNSET;
+
+/*!
+ * \brief The count of the current timer period
+ */
+static uint32_t timerCount;
+
+/*!
+ * \brief Whether the one-shot timer is armed and has not expired yet
+ */
+static uint32_t timerArmed;
+
+/*!
+ * \brief The time stamp counter at the entry of the idle loop, 0 if the
+ *        root is not idle
+ */
+static uint64_t idleSince;
+
+/*!
+ * \brief The idle counters since the last print
+ */
+static struct idle_stats idleStats;
+
+/*!
+ * \fn static void programTimer(uint32_t command, uint32_t count)
+ * \brief Program the channel 0 of the timer
+ * \param command The PIT_PERIODIC or PIT_ONESHOT command
+ * \param count The count of the period
+ */
+static void programTimer(uint32_t command, uint32_t count)
+{
+	Pip_Outb(PIT_COMMAND_PORT, command);
+	Pip_Outb(PIT_CHANNEL0_PORT, count & 0xff);
+	Pip_Outb(PIT_CHANNEL0_PORT, (count >> 8) & 0xff);
+
+	timerCount = count;
+}
+
+/*!
+ * \fn void idleTimer(uint32_t periodic)
+ * \brief Program the timer for the children about to run
+ * \param periodic Whether the timer must tick periodically, when several
+ *        children have work or when the child taking the timer runs
+ * \note The timer is only programmed when its mode changes, or when the
+ *       one-shot timer expired.
+ */
+void idleTimer(uint32_t periodic)
+{
+	if (!idleStats.start)
+	{
+		idleStats.start = readCycles();
+	}
+
+	if (periodic)
+	{
+		if (timerMode != IDLE_TIMER_PERIODIC)
+		{
+			programTimer(PIT_PERIODIC, PIT_FREQUENCY / IDLE_TIMER_HZ);
+			timerMode = IDLE_TIMER_PERIODIC;
+		}
+	}
+	else if (timerMode != IDLE_TIMER_ONESHOT || !timerArmed)
+	{
+		programTimer(PIT_ONESHOT, IDLE_ONESHOT_COUNT);
+		timerMode  = IDLE_TIMER_ONESHOT;
+		timerArmed = 1;
+		idleStats.oneshots++;
+	}
+}
+
+/*!
+ * \fn void idleEnter(uint32_t (*work)(void))
+ * \brief Run the background work, then wait for the next interrupt
+ * \param work The background work, called until it returns 0
+ * \note This function does not return: the next interrupt enters the root
+ *       through the context of its vector, and the interrupted loop is
+ *       abandoned.
+ */
+void idleEnter(uint32_t (*work)(void))
+{
+	idleStats.idleEntries++;
+
+	while (work());
+
+	idleSince = readCycles();
+
+	for (;;)
+	{
+		__asm__ __volatile__ ("pause");
+	}
+}
+
+/*!
+ * \fn void idleWake(uint32_t vector, uint64_t entryCycles)
+ * \brief Account an interrupt entering the root, called by the dispatcher
+ * \param vector The vector the interrupt was triggered on
+ * \param entryCycles The time stamp counter read by the entry stub
+ */
+void idleWake(uint32_t vector, uint64_t entryCycles)
+{
+	idleStats.wakeups++;
+
+	if (idleSince)
+	{
+		idleStats.idleCycles += entryCycles - idleSince;
+		idleStats.idleWakeups++;
+		idleSince = 0;
+	}
+
+	if (vector == TIMER_VECTOR && timerMode != IDLE_TIMER_UNSET)
+	{
+		idleStats.timerCounts += timerCount;
+		timerArmed = 0;
+	}
+}
+
+/*!
+ * \fn static uint32_t perSecond(uint32_t events, uint32_t timerCounts)
+ * \brief Convert a number of events into a rate
+ * \param events The number of events
+ * \param timerCounts The timer counts they happened in, greater than zero
+ * \return The number of events per second
+ */
+static uint32_t perSecond(uint32_t events, uint32_t timerCounts)
+{
+	return averageCycles((uint64_t) events * PIT_FREQUENCY, timerCounts);
+}
+
+/*!
+ * \fn void printIdleStats(struct partition *partitions, uint32_t count)
+ * \brief Print the busy cycles and the wakeups of the root since the last
+ *        print, and the idle yields of the children
+ * \param partitions The child partitions
+ * \param count The number of child partitions
+ */
+void printIdleStats(struct partition *partitions, uint32_t count)
+{
+	uint64_t now = readCycles();
+	uint64_t elapsed = now - idleStats.start;
+
+	printf("IDLE busy=%d%% ", 100 - percentCycles(idleStats.idleCycles,
+				elapsed));
+
+	if (idleStats.timerCounts)
+	{
+		printf("wakeups=%d idle-wakeups=%d ",
+				perSecond(idleStats.wakeups,
+					idleStats.timerCounts),
+				perSecond(idleStats.idleWakeups,
+					idleStats.timerCounts));
+	}
+	else
+	{
+		printf("wakeups=n/a idle-wakeups=n/a ");
+	}
+
+	printf("idle-entries=%d oneshots=%d timer=%s\n",
+			idleStats.idleEntries, idleStats.oneshots,
+			timerMode == IDLE_TIMER_PERIODIC ? "periodic" :
+			timerMode == IDLE_TIMER_ONESHOT ? "oneshot" : "unset");
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		printf("Child %d idle yields ... %d\n", i,
+				partitions[i].idleYields);
+	}
+
+	idleStats.start       = now;
+	idleStats.idleCycles  = 0;
+	idleStats.wakeups     = 0;
+	idleStats.idleWakeups = 0;
+	idleStats.idleEntries = 0;
+	idleStats.timerCounts = 0;
+	idleStats.oneshots    = 0;
+}
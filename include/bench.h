@@ -0,0 +1,128 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the Pip API microbenchmarks, built
+ * into the root partition by "make bench"
+ */
+
+#ifndef __DEF_BENCH_H__
+#define __DEF_BENCH_H__
+
+#include <stdint.h>
+
+#include "partitions.h"
+#include "ring.h"
+
+/*!
+ * \def BENCH_ITERATIONS
+ * \brief The number of samples taken for each benchmark
+ */
+#define BENCH_ITERATIONS	256
+
+/*!
+ * \def BENCH_VECTOR
+ * \brief The unused vector used to benchmark Pip_RegisterInterrupt
+ */
+#define BENCH_VECTOR		40
+
+/*!
+ * \def BENCH_VADDR
+ * \brief The child address where pages are mapped by the benchmarks
+ */
+#define BENCH_VADDR		0x40000000
+
+/*!
+ * \def BENCH_RING_BATCHES
+ * \brief The number of batch sizes of the channel benchmark, from 1 to 64
+ *        messages per yield
+ */
+#define BENCH_RING_BATCHES	7
+
+/*!
+ * \def BENCH_FORWARD_VECTOR
+ * \brief The vector forwarded down the nested launchers by the nesting
+ *        benchmark, the timer vector the root forwards to its children
+ */
+#define BENCH_FORWARD_VECTOR	32
+
+/*!
+ * \def BENCH_FORWARD_SAVE_INDEX
+ * \brief The VIDT slot where a partition forwarding the vector saves its
+ *        context, the child serving it yielding back to this slot
+ */
+#define BENCH_FORWARD_SAVE_INDEX	50
+
+/*!
+ * \def BENCH_NESTING_DEPTHS
+ * \brief The number of nesting depths of the nesting benchmark, the child
+ *        of depth N being the Nth child of bench.conf
+ */
+#define BENCH_NESTING_DEPTHS	4
+
+/*!
+ * \def BENCH_GRANT_SIZES
+ * \brief The number of run sizes of the page grant benchmark, from 4 KiB to
+ *        64 MiB, each four times the previous one
+ */
+#define BENCH_GRANT_SIZES	8
+
+/*!
+ * \def BENCH_GRANT_MAX_PAGES
+ * \brief The number of pages of the largest run of the page grant benchmark
+ */
+#define BENCH_GRANT_MAX_PAGES	(1 << (2 * (BENCH_GRANT_SIZES - 1)))
+
+/*!
+ * \def BENCH_GRANT_ITERATIONS
+ * \brief The number of samples taken for each run size, fewer than for the
+ *        other benchmarks as a sample moves up to 64 MiB
+ */
+#define BENCH_GRANT_ITERATIONS	16
+
+void benchPipCalls(void);
+
+void benchYield(uint32_t descChild);
+
+void benchFpu(void);
+
+void benchRing(uint32_t descChild, struct ring *toChild, struct ring *toRoot);
+
+void benchGrant(struct partition *partition);
+
+void benchRestart(struct partition *partition);
+
+void benchNesting(struct partition *partition, uint32_t depth);
+
+#endif /* __DEF_BENCH_H__ */
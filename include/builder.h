@@ -0,0 +1,132 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the partition builder, which
+ * bootstraps child partitions from their images. It is linked by the root
+ * partition and by the nested launchers of minimal/nested.c, from the
+ * libbuilder.a library.
+ */
+
+#ifndef __DEF_BUILDER_H__
+#define __DEF_BUILDER_H__
+
+#include <stdint.h>
+
+#include <pip/paging.h>
+#include <pip/vidt.h>
+
+#include "partitions.h"
+#include "ring.h"
+
+/*!
+ * \def BUILDER_STACK_VADDR
+ * \brief The child address of the stack page of the default layout, which
+ *        is also where Pip maps the stack page of the root partition
+ */
+#define BUILDER_STACK_VADDR	0xffffe000
+
+/*!
+ * \def BUILDER_SNAPSHOT
+ * \brief Take a restart snapshot of each child once bootstrapped
+ */
+#define BUILDER_SNAPSHOT	0x1
+
+/*!
+ * \struct builder_layout
+ * \brief The addresses of the pages a builder maps into its children, next
+ *        to their images whose load addresses are given by the images
+ * \note The VIDT page is always mapped at VIDT_VADDR, where Pip reads it.
+ */
+struct builder_layout
+{
+	uint32_t stackVAddr;	/*!< The stack page, the context at its top */
+	uint32_t channelVAddr;	/*!< The CHANNEL_PAGES channel pages */
+};
+
+/*!
+ * \def BUILDER_LAYOUT_DEFAULT
+ * \brief The initializer of the default layout, the one of the children
+ *        built in this repository
+ */
+#define BUILDER_LAYOUT_DEFAULT	{ BUILDER_STACK_VADDR, CHANNEL_VADDR }
+
+/*!
+ * \struct builder
+ * \brief A partition builder and the children it launched
+ */
+struct builder
+{
+	struct builder_layout layout;	/*!< The layout of the children */
+	struct partition *partitions;	/*!< The partition slots */
+	uint32_t capacity;		/*!< The number of partition slots */
+	uint32_t count;			/*!< The number of children launched */
+	uint32_t flags;			/*!< The BUILDER_* flags */
+	uint32_t sharingRefused;	/*!< Whether the kernel refused to map
+					     a page into several children */
+};
+
+/*!
+ * \fn static inline void builderInitContext(user_ctx_t *context,
+ *		uint32_t entry, uint32_t stackTop)
+ * \brief Fill a context starting at the given entry point, with interrupts
+ *        enabled
+ * \param context The context to fill
+ * \param entry The address of the first instruction
+ * \param stackTop The initial stack pointer
+ */
+static inline void builderInitContext(user_ctx_t *context, uint32_t entry,
+		uint32_t stackTop)
+{
+	context->valid    = 0;
+	context->eip      = entry;
+	context->pipflags = 0;
+	context->eflags   = 0x202;
+	context->regs.ebp = stackTop;
+	context->regs.esp = stackTop;
+	context->valid    = 1;
+}
+
+void builderInit(struct builder *builder, const struct builder_layout *layout,
+		struct partition *partitions, uint32_t capacity,
+		uint32_t flags);
+
+struct partition *builderLaunch(struct builder *builder,
+		const struct child_image *image);
+
+void builderSendHello(struct partition *partition, uint32_t index);
+
+void builderYield(struct partition *partition);
+
+#endif /* __DEF_BUILDER_H__ */
@@ -0,0 +1,244 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the buffered console of the partitions: a byte ring
+ * shared with the root partition, into which a partition formats its
+ * messages instead of writing them to the serial port. The root partition
+ * drains the consoles to the serial port on timer interrupts. It is included
+ * by both the root partition and the child partitions, and only depends on
+ * the compiler.
+ *
+ * A message that does not fit in the ring is dropped as a whole and counted,
+ * the writer never waits for the root partition.
+ */
+
+#ifndef __DEF_CONSOLE_H__
+#define __DEF_CONSOLE_H__
+
+#include <stdarg.h>
+#include <stdint.h>
+
+#include "ring.h"
+
+/*!
+ * \def CONSOLE_BYTES
+ * \brief The size of the byte ring of a console, a power of two
+ */
+#define CONSOLE_BYTES	2048
+
+/*!
+ * \def CONSOLE_LINE
+ * \brief The maximum size of a formatted message
+ */
+#define CONSOLE_LINE	128
+
+/*!
+ * \struct console
+ * \brief A buffered console, filling less than a page
+ */
+struct console
+{
+	volatile uint32_t head;		/*!< Next byte read by the root */
+	uint32_t headPad[RING_PAD_WORDS];
+	volatile uint32_t tail;		/*!< Next byte written by the writer */
+	volatile uint32_t dropped;	/*!< Messages dropped by the writer */
+	volatile uint32_t work;		/*!< Work units reported by the writer */
+	uint32_t tailPad[RING_PAD_WORDS - 2];
+	char data[CONSOLE_BYTES];	/*!< The byte ring */
+};
+
+/*!
+ * \def CONSOLE_PRINTF(console, ...)
+ * \brief Print a message through a console in the buffered console mode,
+ *        straight to the serial port otherwise
+ */
+#ifdef CONSOLE_BUFFERED
+#define CONSOLE_PRINTF(console, ...)	consolePrintf(console, __VA_ARGS__)
+#else
+#define CONSOLE_PRINTF(console, ...)	printf(__VA_ARGS__)
+#endif
+
+/*!
+ * \fn static inline void consoleInit(struct console *console)
+ * \brief Empty a console, before it is shared
+ * \param console The console
+ */
+static inline void consoleInit(struct console *console)
+{
+	console->head    = 0;
+	console->tail    = 0;
+	console->dropped = 0;
+	console->work    = 0;
+}
+
+/*!
+ * \fn static inline uint32_t consoleNumber(char *buffer, uint32_t length,
+ *		uint32_t value, uint32_t base)
+ * \brief Format an unsigned number at the end of a message
+ * \param buffer The message buffer
+ * \param length The length of the message
+ * \param value The number
+ * \param base The base, 10 or 16
+ * \return The new length of the message
+ */
+static inline uint32_t consoleNumber(char *buffer, uint32_t length,
+		uint32_t value, uint32_t base)
+{
+	char digits[10];
+	uint32_t count = 0;
+
+	do
+	{
+		digits[count++] = "0123456789abcdef"[value % base];
+		value /= base;
+	}
+	while (value);
+
+	while (count && length < CONSOLE_LINE)
+	{
+		buffer[length++] = digits[--count];
+	}
+
+	return length;
+}
+
+/*!
+ * \fn static inline uint32_t consoleFormat(char *buffer, const char *format,
+ *		va_list args)
+ * \brief Format a message, supporting %d, %u, %x, %c, %s and %%
+ * \param buffer The message buffer, of CONSOLE_LINE bytes
+ * \param format The format string
+ * \param args The arguments
+ * \return The length of the message, truncated to CONSOLE_LINE bytes
+ */
+static inline uint32_t consoleFormat(char *buffer, const char *format,
+		va_list args)
+{
+	uint32_t length = 0;
+
+	for (; *format && length < CONSOLE_LINE; format++)
+	{
+		if (*format != '%')
+		{
+			buffer[length++] = *format;
+			continue;
+		}
+
+		switch (*++format)
+		{
+			case 'd':
+			{
+				int32_t value = va_arg(args, int32_t);
+
+				if (value < 0)
+				{
+					buffer[length++] = '-';
+				}
+
+				length = consoleNumber(buffer, length, value < 0 ?
+						-(uint32_t) value : (uint32_t) value,
+						10);
+				break;
+			}
+			case 'u':
+				length = consoleNumber(buffer, length,
+						va_arg(args, uint32_t), 10);
+				break;
+			case 'x':
+				length = consoleNumber(buffer, length,
+						va_arg(args, uint32_t), 16);
+				break;
+			case 'c':
+				buffer[length++] = (char) va_arg(args, int);
+				break;
+			case 's':
+			{
+				const char *string = va_arg(args, const char*);
+
+				while (*string && length < CONSOLE_LINE)
+				{
+					buffer[length++] = *string++;
+				}
+
+				break;
+			}
+			case '\0':
+				return length;
+			default:
+				buffer[length++] = *format;
+		}
+	}
+
+	return length;
+}
+
+/*!
+ * \fn static inline uint32_t consolePrintf(struct console *console,
+ *		const char *format, ...)
+ * \brief Format a message into a console
+ * \param console The console
+ * \param format The format string, see consoleFormat
+ * \return 1 if the message was written, 0 if it was dropped
+ */
+static inline uint32_t consolePrintf(struct console *console,
+		const char *format, ...)
+{
+	char buffer[CONSOLE_LINE];
+	va_list args;
+
+	va_start(args, format);
+	uint32_t length = consoleFormat(buffer, format, args);
+	va_end(args);
+
+	uint32_t tail = console->tail;
+
+	if (length > CONSOLE_BYTES - (tail - console->head))
+	{
+		console->dropped++;
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < length; i++)
+	{
+		console->data[(tail + i) & (CONSOLE_BYTES - 1)] = buffer[i];
+	}
+
+	RING_BARRIER();
+	console->tail = tail + length;
+
+	return 1;
+}
+
+#endif /* __DEF_CONSOLE_H__ */
@@ -0,0 +1,71 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the draining of the buffered
+ * consoles by the root partition
+ */
+
+#ifndef __DEF_CONSOLES_H__
+#define __DEF_CONSOLES_H__
+
+#include <stdint.h>
+
+#include "console.h"
+#include "partitions.h"
+
+/*!
+ * \def CONSOLE_DRAIN_BUDGET
+ * \brief The maximum number of bytes written to the serial port per drain
+ */
+#define CONSOLE_DRAIN_BUDGET	512
+
+/*!
+ * \def CONSOLE_STATS_PERIOD
+ * \brief The number of time slices of a child between its console counters
+ */
+#define CONSOLE_STATS_PERIOD	64
+
+/*!
+ * \brief The console of the root partition
+ */
+extern struct console rootConsole;
+
+void consolesDrain(struct partition *partitions, uint32_t count);
+
+void consoleEndSlice(struct partition *partition, uint32_t index);
+
+void printConsoleStats(struct partition *partition, uint32_t index);
+
+#endif /* __DEF_CONSOLES_H__ */
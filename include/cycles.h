@@ -0,0 +1,103 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the cycle counter helpers
+ */
+
+#ifndef __DEF_CYCLES_H__
+#define __DEF_CYCLES_H__
+
+#include <stdint.h>
+
+/*!
+ * \fn static inline uint64_t readCycles(void)
+ * \brief Read the time stamp counter of the processor
+ * \return The current value of the time stamp counter
+ */
+static inline uint64_t readCycles(void)
+{
+	uint32_t low, high;
+
+	__asm__ volatile ("rdtsc" : "=a" (low), "=d" (high));
+
+	return ((uint64_t) high << 32) | low;
+}
+
+/*!
+ * \fn static inline uint32_t averageCycles(uint64_t total, uint32_t count)
+ * \brief Divide a cycle count by a number of samples
+ * \param total The total number of cycles
+ * \param count The number of samples, greater than zero
+ * \return The average number of cycles, saturated to 32 bits
+ * \note The root partition is not linked with libgcc, which provides the
+ *       64-bit division: the divl instruction is used instead
+ */
+static inline uint32_t averageCycles(uint64_t total, uint32_t count)
+{
+	uint32_t high = (uint32_t) (total >> 32);
+	uint32_t low  = (uint32_t) total;
+	uint32_t quotient;
+
+	if (high >= count)
+	{
+		return 0xffffffff;
+	}
+
+	__asm__ ("divl %2" : "=a" (quotient), "+d" (high) : "rm" (count),
+			"0" (low));
+
+	return quotient;
+}
+
+/*!
+ * \fn static inline uint32_t percentCycles(uint64_t part, uint64_t whole)
+ * \brief Compute the percentage of a cycle count
+ * \param part The cycle count
+ * \param whole The total cycle count, greater than or equal to part
+ * \return The percentage, 0 when the total is 0
+ */
+static inline uint32_t percentCycles(uint64_t part, uint64_t whole)
+{
+	// Keep the divisor in 32 bits for averageCycles
+	while (whole >> 32)
+	{
+		part  >>= 1;
+		whole >>= 1;
+	}
+
+	return whole ? averageCycles(part * 100, (uint32_t) whole) : 0;
+}
+
+#endif /* __DEF_CYCLES_H__ */
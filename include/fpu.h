@@ -0,0 +1,86 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the lazy FPU state switching
+ */
+
+#ifndef __DEF_FPU_H__
+#define __DEF_FPU_H__
+
+#include <stdint.h>
+
+#include "partitions.h"
+
+/*!
+ * \def FPU_FCW_DEFAULT
+ * \brief The x87 control word set by fninit
+ */
+#define FPU_FCW_DEFAULT		0x037f
+
+/*!
+ * \def FPU_MXCSR_DEFAULT
+ * \brief The SSE control and status register at reset, exceptions masked
+ */
+#define FPU_MXCSR_DEFAULT	0x1f80
+
+/*!
+ * \def FPU_MXCSR_OFFSET
+ * \brief The offset of MXCSR in an fxsave area
+ */
+#define FPU_MXCSR_OFFSET	24
+
+/*!
+ * \struct fpu_stats
+ * \brief Counters of the FPU state switches
+ */
+struct fpu_stats
+{
+	uint32_t integerSwitches;	/*!< Switches to integer-only children */
+	uint32_t ownerSwitches;		/*!< Switches to the FPU owner */
+	uint32_t stateSwitches;		/*!< Switches saving and restoring */
+	uint64_t integerCycles;		/*!< Cycles of the integer switches */
+	uint64_t ownerCycles;		/*!< Cycles of the owner switches */
+	uint64_t stateCycles;		/*!< Cycles of the state switches */
+};
+
+void fpuInitArea(uint32_t *area);
+
+void fpuSwitch(struct partition *next);
+
+void fpuForget(struct partition *partition);
+
+void printFpuStats(void);
+
+#endif /* __DEF_FPU_H__ */
@@ -0,0 +1,76 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the page grants, which move runs of
+ * pages between the root partition and its children without copying them
+ */
+
+#ifndef __DEF_GRANT_H__
+#define __DEF_GRANT_H__
+
+#include <stdint.h>
+
+#include "map.h"
+
+/*!
+ * \def GRANT_ROOT
+ * \brief The holder of a run kept by the root partition, no child
+ *        descriptor being null
+ */
+#define GRANT_ROOT	0
+
+/*!
+ * \struct grant
+ * \brief A run of pages, mapped at consecutive addresses in the child
+ *        holding it
+ */
+struct grant
+{
+	uint32_t *pages;	/*!< The root addresses of the pages */
+	uint32_t count;		/*!< The number of pages */
+	uint32_t holder;	/*!< GRANT_ROOT or the descriptor of the child
+				     holding the run */
+	uint32_t vaddr;		/*!< The address of the run in the child holding
+				     it */
+};
+
+uint32_t grantAlloc(struct grant *grant, uint32_t *pages, uint32_t count);
+
+uint32_t grantMove(struct grant *grant, uint32_t descChild, uint32_t owner,
+		uint32_t vaddr, struct map_stats *stats);
+
+uint32_t grantFree(struct grant *grant, struct map_stats *stats);
+
+#endif /* __DEF_GRANT_H__ */
@@ -0,0 +1,127 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the idle loop and of the tickless
+ * timer of the root partition
+ */
+
+#ifndef __DEF_IDLE_H__
+#define __DEF_IDLE_H__
+
+#include <stdint.h>
+
+#include "partitions.h"
+
+/*!
+ * \def PIT_FREQUENCY
+ * \brief The input frequency of the programmable interval timer, in hertz
+ */
+#define PIT_FREQUENCY		1193182
+
+/*!
+ * \def PIT_CHANNEL0_PORT
+ * \brief The data port of the channel 0 of the timer, wired to the IRQ 0
+ */
+#define PIT_CHANNEL0_PORT	0x40
+
+/*!
+ * \def PIT_COMMAND_PORT
+ * \brief The mode and command port of the timer
+ */
+#define PIT_COMMAND_PORT	0x43
+
+/*!
+ * \def PIT_PERIODIC
+ * \brief The command of the channel 0 as a rate generator, mode 2, the
+ *        count being written low byte first
+ */
+#define PIT_PERIODIC		0x34
+
+/*!
+ * \def PIT_ONESHOT
+ * \brief The command of the channel 0 interrupting once on the terminal
+ *        count, mode 0, the count being written low byte first
+ */
+#define PIT_ONESHOT		0x30
+
+/*!
+ * \def IDLE_TIMER_HZ
+ * \brief The frequency of the periodic timer, when several children have
+ *        work to share the processor
+ */
+#define IDLE_TIMER_HZ		100
+
+/*!
+ * \def IDLE_ONESHOT_COUNT
+ * \brief The count of the one-shot timer, the longest the channel 0 can
+ *        wait, about 55 ms
+ */
+#define IDLE_ONESHOT_COUNT	0xffff
+
+/*!
+ * \enum idle_timer
+ * \brief The programming of the timer
+ */
+enum idle_timer
+{
+	IDLE_TIMER_UNSET,	/*!< Left as the kernel programmed it */
+	IDLE_TIMER_PERIODIC,	/*!< Ticking at IDLE_TIMER_HZ */
+	IDLE_TIMER_ONESHOT	/*!< Interrupting once after IDLE_ONESHOT_COUNT */
+};
+
+/*!
+ * \struct idle_stats
+ * \brief The idle counters of the root partition since the last print
+ */
+struct idle_stats
+{
+	uint64_t start;		/*!< Time stamp counter of the first count */
+	uint64_t idleCycles;	/*!< Cycles spent in the idle loop */
+	uint32_t wakeups;	/*!< Interrupts entering the root */
+	uint32_t idleWakeups;	/*!< Interrupts ending the idle loop */
+	uint32_t idleEntries;	/*!< Entries of the idle loop */
+	uint32_t timerCounts;	/*!< Timer counts of the expired periods */
+	uint32_t oneshots;	/*!< One-shot periods armed */
+};
+
+void idleTimer(uint32_t periodic);
+
+void idleEnter(uint32_t (*work)(void)) __attribute__((noreturn));
+
+void idleWake(uint32_t vector, uint64_t entryCycles);
+
+void printIdleStats(struct partition *partitions, uint32_t count);
+
+#endif /* __DEF_IDLE_H__ */
@@ -0,0 +1,101 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the interrupt dispatch registry
+ */
+
+#ifndef __DEF_IRQ_H__
+#define __DEF_IRQ_H__
+
+#include <stdint.h>
+
+#include <pip/vidt.h>
+
+/*!
+ * \def IRQ_VECTORS
+ * \brief The number of VIDT vectors
+ */
+#define IRQ_VECTORS	256
+
+/*!
+ * \def IRQ_STUB_SIZE
+ * \brief The size of each entry stub, see irqstubs.S
+ */
+#define IRQ_STUB_SIZE	16
+
+/*!
+ * \typedef irq_handler_t
+ * \brief An interrupt handler, called with the vector it was triggered on
+ * \note A handler returning lets the dispatcher resume the interrupted
+ *       partitions through the resume function given to irqInit.
+ */
+typedef void (*irq_handler_t)(uint32_t vector);
+
+/*!
+ * \typedef irq_forward_t
+ * \brief A function forwarding a delegated vector to the current child
+ * \return 1 if the interrupt was forwarded and the child yielded back to the
+ *         root, 0 if the interrupt must be served by the root handler
+ * \note The function calls traceResume before yielding to the child.
+ */
+typedef uint32_t (*irq_forward_t)(uint32_t vector);
+
+/*!
+ * \struct irq_entry
+ * \brief A registered interrupt handler
+ */
+struct irq_entry
+{
+	irq_handler_t handler;	/*!< The handler, 0 if none is registered */
+	user_ctx_t *context;	/*!< The context allocated for the vector */
+	uint32_t stack;		/*!< The stack page allocated for the vector */
+	uint32_t delegated;	/*!< Whether the vector is forwarded first */
+	uint32_t count;		/*!< Number of interrupts dispatched */
+	uint32_t forwarded;	/*!< Number of interrupts forwarded */
+	uint64_t cycles;	/*!< Cycles spent by the root per interrupt */
+	uint32_t maxCycles;	/*!< Maximum cycles spent for an interrupt */
+};
+
+void irqInit(void (*resume)(void), irq_forward_t forward);
+
+uint32_t irqRegister(uint32_t vector, irq_handler_t handler);
+
+void irqDelegate(uint32_t vector);
+
+void irqDispatch(uint64_t entryCycles, uint32_t vector);
+
+void printIrqStats(void);
+
+#endif /* __DEF_IRQ_H__ */
@@ -34,6 +34,7 @@
 /*!
  * \file
  * This file contains the constant definition used by the root partition
+ * and the partition builder
  */
 
 #ifndef __DEF_LAUNCHER_H__
@@ -63,6 +64,24 @@
  */
 #define FAIL_MAP_VIDT_PAGE	4
 
+/*!
+ * \def FAIL_DECOMPRESS_IMAGE
+ * \brief Decompress image error code
+ */
+#define FAIL_DECOMPRESS_IMAGE	5
+
+/*!
+ * \def FAIL_MAP_CHANNEL_PAGE
+ * \brief Map channel page error code
+ */
+#define FAIL_MAP_CHANNEL_PAGE	6
+
+/*!
+ * \def FAIL_ALLOC_FPU_AREA
+ * \brief Allocate FPU save area error code
+ */
+#define FAIL_ALLOC_FPU_AREA	7
+
 /*!
  * \def FAIL_INVALID_INT_LEVEL
  * \brief Invalid interrupt level error code
@@ -124,25 +143,52 @@
 #define BOOTINFO_VADDR	0xffffc000
 
 /*!
- * \def STACK_TOP_VADDR
- * \brief The stack top address
+ * \def INVALID_OPCODE_VECTOR
+ * \brief The invalid opcode exception vector
+ */
+#define INVALID_OPCODE_VECTOR	6
+
+/*!
+ * \def GENERAL_PROTECTION_VECTOR
+ * \brief The general protection exception vector
+ */
+#define GENERAL_PROTECTION_VECTOR	13
+
+/*!
+ * \def PAGE_FAULT_VECTOR
+ * \brief The page fault exception vector
+ */
+#define PAGE_FAULT_VECTOR	14
+
+/*!
+ * \def TIMER_VECTOR
+ * \brief The timer interrupt vector
+ */
+#define TIMER_VECTOR	32
+
+/*!
+ * \def KEYBOARD_VECTOR
+ * \brief The keyboard interrupt vector
  */
-#define STACK_TOP_VADDR 0xffffe000
+#define KEYBOARD_VECTOR	33
 
 /*!
- * \def LOAD_VADDRESS
- * \brief The virtual address where to load the child
+ * \def MAX_PARTITIONS
+ * \brief The maximum number of child partitions launched by the root
  */
-#define LOAD_VADDRESS	0x700000
+#define MAX_PARTITIONS	64
 
 /*!
  * \def PANIC()
  * \brief The macro used for unexpected behavior
+ * \note The host simulator of sim/ defines its own, which ends the run.
  */
+#ifndef PANIC
 #define PANIC()				\
 	do {				\
 		printf("Panic!\n");	\
 		for (;;);		\
 	} while (0)
+#endif
 
 #endif /* __DEF_LAUNCHER_H__ */
@@ -0,0 +1,73 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the demand paging of child images
+ */
+
+#ifndef __DEF_LAZY_H__
+#define __DEF_LAZY_H__
+
+#include <stdint.h>
+
+#include <pip/paging.h>
+#include <pip/wrappers.h>
+
+#include "partitions.h"
+
+/*!
+ * \def LAZY_MAX_PAGES
+ * \brief The maximum number of lazy pages of a child, one bitmap page worth
+ */
+#define LAZY_MAX_PAGES	(PAGE_SIZE * 8)
+
+/*!
+ * \struct lazy_stats
+ * \brief Counters of the page faults served by the root partition
+ */
+struct lazy_stats
+{
+	uint32_t faults;	/*!< Faults served */
+	uint32_t mappedPages;	/*!< Lazy pages mapped while serving faults */
+	uint64_t cycles;	/*!< Cycles spent to serve the faults */
+};
+
+enum map_page_wrapper_ret_e lazyMapReadOnly(struct partition *partition,
+		uint32_t readOnlySize, uint32_t flags);
+
+uint32_t lazyServeFault(struct partition *partition);
+
+void printLazyStats(void);
+
+#endif /* __DEF_LAZY_H__ */
@@ -0,0 +1,80 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the compressed child images
+ */
+
+#ifndef __DEF_LZ4_H__
+#define __DEF_LZ4_H__
+
+#include <stdint.h>
+
+#include <pip/wrappers.h>
+
+#include "partitions.h"
+
+/*!
+ * \def LZ4_IMAGE_MAGIC
+ * \brief The magic number of a compressed child image ("PLZ4")
+ */
+#define LZ4_IMAGE_MAGIC	0x345a4c50
+
+/*!
+ * \def LZ4_BLOCK_RAW
+ * \brief Flag of a block size telling the page is stored uncompressed
+ */
+#define LZ4_BLOCK_RAW	0x80000000
+
+/*!
+ * \struct lz4_image_header
+ * \brief The header of a compressed child image, written by tools/lz4pack
+ * \note The header is followed by the size of the block of each page, then
+ *       by the blocks. Each page is compressed as an independent LZ4 block.
+ */
+struct lz4_image_header
+{
+	uint32_t magic;			/*!< LZ4_IMAGE_MAGIC */
+	uint32_t imageSize;		/*!< The size of the uncompressed image */
+	struct image_layout layout;	/*!< The layout footer of the image */
+	uint32_t blockSizes[];		/*!< The size of each block */
+};
+
+const struct lz4_image_header *lz4ImageHeader(
+		const struct child_image *image);
+
+enum map_page_wrapper_ret_e lz4MapPages(struct partition *partition,
+		uint32_t offset, uint32_t size, uint32_t flags);
+
+#endif /* __DEF_LZ4_H__ */
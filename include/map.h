@@ -0,0 +1,105 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the range mapping functions
+ */
+
+#ifndef __DEF_MAP_H__
+#define __DEF_MAP_H__
+
+#include <stdint.h>
+
+#include <pip/wrappers.h>
+
+/*!
+ * \def PAGE_TABLE_SPAN
+ * \brief The size of the virtual range covered by one page table
+ */
+#define PAGE_TABLE_SPAN	0x400000
+
+/*!
+ * \def MAP_WRITE
+ * \brief Map the pages writable, they are mapped read-only otherwise
+ */
+#define MAP_WRITE	0x1
+
+/*!
+ * \def MAP_COPY
+ * \brief Map private copies of the source pages
+ */
+#define MAP_COPY	0x2
+
+/*!
+ * \def MAP_ZERO
+ * \brief Map newly allocated zeroed pages, the source is ignored
+ */
+#define MAP_ZERO	0x4
+
+/*!
+ * \def MAP_SHARE
+ * \brief Map the source pages themselves, or private copies of them when
+ *        the kernel refuses to map them into one more partition
+ */
+#define MAP_SHARE	0x8
+
+/*!
+ * \struct map_stats
+ * \brief Counters filled by the range mapping functions
+ */
+struct map_stats
+{
+	uint32_t kernelCalls;	/*!< Number of Pip system calls issued */
+	uint32_t prepareCalls;	/*!< Number of Pip_Prepare calls issued */
+	uint32_t preparePages;	/*!< Pages given to the kernel by Pip_Prepare */
+	uint32_t mappedPages;	/*!< Pages added to the child partition */
+	uint32_t copiedPages;	/*!< Pages allocated to hold a copy */
+	uint32_t zeroedPages;	/*!< Pages allocated and zeroed */
+	uint32_t decompressedPages; /*!< Pages allocated and decompressed */
+};
+
+enum map_page_wrapper_ret_e prepareRange(uint32_t descChild,
+		uint32_t loadAddress, uint32_t size, struct map_stats *stats);
+
+enum map_page_wrapper_ret_e mapPreparedPage(uint32_t descChild,
+		uint32_t source, uint32_t vaddr, uint32_t flags,
+		struct map_stats *stats);
+
+enum map_page_wrapper_ret_e mapRange(uint32_t descChild, uint32_t base,
+		uint32_t size, uint32_t loadAddress, uint32_t flags,
+		struct map_stats *stats);
+
+void printMapStats(const struct map_stats *stats);
+
+#endif /* __DEF_MAP_H__ */
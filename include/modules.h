@@ -0,0 +1,98 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the discovery of the child images
+ * passed as boot modules
+ */
+
+#ifndef __DEF_MODULES_H__
+#define __DEF_MODULES_H__
+
+#include <stdint.h>
+
+#include "partitions.h"
+
+/*!
+ * \def MODULES_MAGIC
+ * \brief The magic number of the boot module directory ("MODS")
+ */
+#define MODULES_MAGIC		0x53444f4d
+
+/*!
+ * \def MODULE_NAME_SIZE
+ * \brief The size of the name of a boot module, its final zero included
+ */
+#define MODULE_NAME_SIZE	16
+
+/*!
+ * \struct module_entry
+ * \brief A child image passed as a boot module
+ */
+struct module_entry
+{
+	char name[MODULE_NAME_SIZE];	/*!< The name given in the manifest */
+	uint32_t offset;	/*!< The offset of the image in the directory */
+	uint32_t size;		/*!< The size of the image content */
+	uint32_t loadAddress;	/*!< The child address of the image */
+	uint32_t flags;		/*!< The CHILD_* options of the manifest */
+	uint32_t colors;	/*!< The cache colors of its pages, 0 for any */
+	uint32_t priority;	/*!< The scheduling priority, 0 the lowest */
+	uint32_t budget;	/*!< The timer ticks per scheduling epoch */
+};
+
+/*!
+ * \struct module_directory
+ * \brief The boot module directory written by tools/modpack, loaded by the
+ *        bootloader at the start of the free memory
+ * \note The images follow the entries, each starting on a page boundary
+ *       of the directory. Several entries with the same offset are
+ *       instances of the same image.
+ */
+struct module_directory
+{
+	uint32_t magic;		/*!< MODULES_MAGIC */
+	uint32_t count;		/*!< The number of entries */
+	uint32_t size;		/*!< The size of the directory, images included */
+	uint32_t reserved;	/*!< Always 0 */
+	struct module_entry entries[];	/*!< The child images */
+};
+
+uint32_t modulesScan(uint32_t memoryBegin, uint32_t memoryEnd);
+
+uint32_t modulesCount(void);
+
+const struct child_image *modulesImage(uint32_t index);
+
+#endif /* __DEF_MODULES_H__ */
@@ -0,0 +1,101 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the helpers used to fill, copy and compare memory pages
+ */
+
+#ifndef __DEF_PAGEOPS_H__
+#define __DEF_PAGEOPS_H__
+
+#include <stdint.h>
+
+#include <pip/paging.h>
+
+/*!
+ * \fn static inline void zeroPage(uint32_t page)
+ * \brief Fill a memory page with zeros
+ * \param page The address of the page
+ */
+static inline void zeroPage(uint32_t page)
+{
+	uint32_t *words = (uint32_t*) page;
+
+	for (uint32_t i = 0; i < PAGE_SIZE / sizeof(uint32_t); i++)
+	{
+		words[i] = 0;
+	}
+}
+
+/*!
+ * \fn static inline void copyPage(uint32_t destination, uint32_t source)
+ * \brief Copy a memory page
+ * \param destination The address of the destination page
+ * \param source The address of the source page
+ */
+static inline void copyPage(uint32_t destination, uint32_t source)
+{
+	uint32_t *to   = (uint32_t*) destination;
+	uint32_t *from = (uint32_t*) source;
+
+	for (uint32_t i = 0; i < PAGE_SIZE / sizeof(uint32_t); i++)
+	{
+		to[i] = from[i];
+	}
+}
+
+/*!
+ * \fn static inline uint32_t samePage(uint32_t page, uint32_t other)
+ * \brief Compare two memory pages
+ * \param page The address of the first page
+ * \param other The address of the second page
+ * \return 1 if the pages hold the same content, 0 otherwise
+ */
+static inline uint32_t samePage(uint32_t page, uint32_t other)
+{
+	uint32_t *words  = (uint32_t*) page;
+	uint32_t *others = (uint32_t*) other;
+
+	for (uint32_t i = 0; i < PAGE_SIZE / sizeof(uint32_t); i++)
+	{
+		if (words[i] != others[i])
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+#endif /* __DEF_PAGEOPS_H__ */
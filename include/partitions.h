@@ -0,0 +1,172 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the child partition table built from the partition
+ * manifest
+ */
+
+#ifndef __DEF_PARTITIONS_H__
+#define __DEF_PARTITIONS_H__
+
+#include <stdint.h>
+
+#include <pip/vidt.h>
+
+#include "console.h"
+#include "map.h"
+#include "ring.h"
+
+/*!
+ * \struct child_image
+ * \brief A child image listed in the partition manifest
+ * \note The table of child images is generated by tools/genpartitions.sh
+ */
+struct child_image
+{
+	const char *name;	/*!< The name given in the manifest */
+	uint32_t start;		/*!< The start address of the image */
+	uint32_t end;		/*!< The page-aligned end address of the image */
+	uint32_t imageEnd;	/*!< The end address of the image content */
+	uint32_t loadAddress;	/*!< The child address of the image */
+	uint32_t flags;		/*!< The CHILD_* options of the manifest */
+	uint32_t colors;	/*!< The cache colors of its pages, 0 for any */
+	uint32_t priority;	/*!< The scheduling priority, 0 the lowest */
+	uint32_t budget;	/*!< The timer ticks per scheduling epoch, 0 for
+				     SCHED_DEFAULT_BUDGET */
+};
+
+/*!
+ * \def CHILD_LAZY
+ * \brief The read-only pages of the image are mapped on first access
+ *        ("lazy" option of the manifest)
+ */
+#define CHILD_LAZY	0x1
+
+/*!
+ * \def CHILD_LZ4
+ * \brief The image is embedded compressed by tools/lz4pack and decompressed
+ *        at bootstrap ("lz4" option of the manifest)
+ */
+#define CHILD_LZ4	0x2
+
+/*!
+ * \def CHILD_TIMER
+ * \brief The timer interrupts are forwarded to the child's VIDT without
+ *        calling the timer handler of the root ("timer" option of the
+ *        manifest)
+ */
+#define CHILD_TIMER	0x4
+
+/*!
+ * \def CHILD_FPU
+ * \brief The child uses the FPU and SSE registers, which the root saves and
+ *        restores across its switches ("fpu" option of the manifest)
+ */
+#define CHILD_FPU	0x8
+
+/*!
+ * \def CHILD_UNALIGNED
+ * \brief The image is not page-aligned, its pages are copied rather than
+ *        mapped in place (set for the boot modules, not a manifest option)
+ */
+#define CHILD_UNALIGNED	0x10
+
+/*!
+ * \def IMAGE_LAYOUT_MAGIC
+ * \brief The magic number of the layout footer of a child image ("LAYT")
+ */
+#define IMAGE_LAYOUT_MAGIC	0x5459414c
+
+/*!
+ * \struct image_layout
+ * \brief The footer ending a child image, written by its link.ld file
+ * \note The image starts with its read-only pages, text and rodata, and
+ *       goes on with its writable data up to the footer. The bss pages
+ *       follow the image in the child address space.
+ */
+struct image_layout
+{
+	uint32_t magic;		/*!< IMAGE_LAYOUT_MAGIC */
+	uint32_t readOnlySize;	/*!< The page-aligned size of text and rodata */
+	uint32_t bssSize;	/*!< The size of the bss */
+};
+
+/*!
+ * \struct partition
+ * \brief A child partition launched by the root partition
+ */
+struct partition
+{
+	const struct child_image *image;	/*!< The image of the child */
+	uint32_t descriptor;		/*!< The child partition descriptor */
+	user_ctx_t *context;		/*!< The initial child context */
+	uint32_t bootstrapCycles;	/*!< Cycles spent to bootstrap it */
+	struct map_stats mapStats;	/*!< The image mapping counters */
+	uint32_t lazyFlags;		/*!< The MAP_* flags of lazy pages */
+	uint32_t lazyPages;		/*!< The number of lazy pages */
+	uint32_t *lazyBitmap;		/*!< The lazy pages already mapped */
+	struct ring *toChild;		/*!< The root to child ring */
+	struct ring *toRoot;		/*!< The child to root ring */
+	struct console *console;	/*!< The console of the child */
+	uint32_t consoleBytes;		/*!< Bytes drained from the console */
+	uint32_t consoleWork;		/*!< Work units at the last slice end */
+	uint64_t sliceWork;		/*!< Work units over the slices */
+	uint32_t slices;		/*!< Time slices ended by the timer */
+	uint32_t idleYields;		/*!< Yields to the idle vector */
+	uint32_t schedState;		/*!< SCHED_QUEUED or SCHED_SLEEPING */
+	uint32_t schedPrev;		/*!< Previous child of its run queue */
+	uint32_t schedNext;		/*!< Next child of its run queue */
+	uint32_t schedEpoch;		/*!< The epoch it may run in */
+	uint32_t budgetLeft;		/*!< Ticks left in its epoch */
+	uint32_t ticks;			/*!< Timer ticks charged to it */
+	uint32_t switches;		/*!< Switches to it from another child */
+	uint64_t cpuCycles;		/*!< Cycles it ran for */
+	uint32_t *fpuArea;		/*!< The FPU save area, 0 if unused */
+	struct snapshot *snapshot;	/*!< The restart snapshot, 0 if none */
+};
+
+/*!
+ * \brief The child images listed in the partition manifest
+ * \note This symbol is defined in the generated partitions.S file
+ */
+extern const struct child_image __childImages[];
+
+/*!
+ * \brief The number of child images listed in the partition manifest
+ * \note This symbol is defined in the generated partitions.S file
+ */
+extern const uint32_t __childImagesCount;
+
+#endif /* __DEF_PARTITIONS_H__ */
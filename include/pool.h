@@ -0,0 +1,177 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the page pool of the root partition
+ */
+
+#ifndef __DEF_POOL_H__
+#define __DEF_POOL_H__
+
+#include <stdint.h>
+
+#include <pip/paging.h>
+
+/*!
+ * \def POOL_FREE
+ * \brief Owner of the pages held by the pool
+ */
+#define POOL_FREE	0x00
+
+/*!
+ * \def POOL_ROOT
+ * \brief Owner of the pages used by the root partition itself
+ */
+#define POOL_ROOT	0xff
+
+/*!
+ * \def POOL_OWNER(index)
+ * \brief Owner of the pages handed to the child partition of this index
+ */
+#define POOL_OWNER(index)	((index) + 1)
+
+/*!
+ * \def POOL_ZEROED_TARGET
+ * \brief The number of pre-zeroed pages the pool tries to keep in stock
+ */
+#define POOL_ZEROED_TARGET	64
+
+/*!
+ * \def POOL_ZERO_BATCH
+ * \brief The maximum number of pages zeroed by one call to poolZeroIdle
+ */
+#define POOL_ZERO_BATCH		8
+
+/*!
+ * \def POOL_COLORS
+ * \brief The number of cache colors, the pages of a color sharing the same
+ *        sets of the last-level cache
+ * \note A color spans one page of a cache way: 32 colors fit a 2 MiB
+ *       16-way cache. The colors of a partition are given as a mask, there
+ *       are at most 32 of them.
+ */
+#ifndef POOL_COLORS
+#define POOL_COLORS	32
+#endif
+
+/*!
+ * \def POOL_COLOR(page)
+ * \brief The cache color of the page at this address
+ */
+#define POOL_COLOR(page)	(((page) / PAGE_SIZE) % POOL_COLORS)
+
+/*!
+ * \def POOL_ALL_COLORS
+ * \brief The mask of all the cache colors
+ */
+#define POOL_ALL_COLORS	((uint32_t) ((1ULL << POOL_COLORS) - 1))
+
+/*!
+ * \enum pool_category
+ * \brief The use of the pages allocated from the pool
+ */
+enum pool_category
+{
+	POOL_OTHER,	/*!< Any other page */
+	POOL_IMAGE,	/*!< Image, decompressed image and bss pages */
+	POOL_STACK,	/*!< Stack pages */
+	POOL_VIDT,	/*!< VIDT pages */
+	POOL_PARTITION,	/*!< Descriptor, page directory, shadows and
+			     configuration pages list */
+	POOL_PREPARE,	/*!< Pages given to the kernel by Pip_Prepare */
+	POOL_CHANNEL,	/*!< Channel pages */
+	POOL_SNAPSHOT,	/*!< Restart snapshot pages */
+	POOL_GRANT,	/*!< Pages of the runs granted by grant.c */
+	POOL_BENCH,	/*!< Pages sampled by the benchmarks */
+	POOL_CATEGORIES
+};
+
+/*!
+ * \struct pool_account
+ * \brief The pages held by an owner of the pool, by category
+ */
+struct pool_account
+{
+	uint32_t live[POOL_CATEGORIES];	/*!< Pages held */
+	uint32_t peak[POOL_CATEGORIES];	/*!< Most pages ever held */
+	uint32_t liveTotal;		/*!< Pages held, all categories */
+	uint32_t peakTotal;		/*!< Most pages ever held */
+};
+
+/*!
+ * \struct pool_stats
+ * \brief Counters of the page pool
+ */
+struct pool_stats
+{
+	uint32_t fromPip;	/*!< Pages obtained from Pip_AllocPage */
+	uint32_t recycled;	/*!< Pages returned by torn down partitions */
+	uint32_t zeroedHits;	/*!< Zeroed pages served from the stock */
+	uint32_t zeroedMisses;	/*!< Zeroed pages zeroed on request */
+	uint32_t idleZeroed;	/*!< Pages zeroed by poolZeroIdle */
+	uint32_t colored;	/*!< Pages allocated with a color mask */
+	uint32_t stashed;	/*!< Pages of other colors set aside */
+};
+
+uint32_t poolInit(uint32_t memoryBegin, uint32_t memoryEnd);
+
+void poolSetOwner(uint32_t owner);
+
+uint32_t poolSetCategory(uint32_t category);
+
+uint32_t poolSetColors(uint32_t colors);
+
+uint32_t *poolAllocPage(void);
+
+uint32_t *poolAllocZeroedPage(void);
+
+uint32_t poolRelease(uint32_t owner);
+
+void poolTransfer(uint32_t *page, uint32_t category, uint32_t owner);
+
+void poolFree(uint32_t *page, uint32_t category);
+
+uint32_t poolZeroIdle(void);
+
+const struct pool_account *poolAccount(uint32_t owner);
+
+const struct pool_account *poolTotals(void);
+
+uint32_t poolFreePages(void);
+
+void printPoolStats(void);
+
+void printPoolAccount(const struct pool_account *account);
+
+#endif /* __DEF_POOL_H__ */
@@ -0,0 +1,79 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the boot-phase profiler
+ */
+
+#ifndef __DEF_PROFILE_H__
+#define __DEF_PROFILE_H__
+
+#include <stdint.h>
+
+/*!
+ * \def PROFILE_RECORDS
+ * \brief The number of phase events recorded by the profiler
+ */
+#define PROFILE_RECORDS	32
+
+/*!
+ * \def PROFILE_PHASES
+ * \brief The number of boot phases
+ */
+#define PROFILE_PHASES	PROFILE_READY
+
+/*!
+ * \enum profile_event
+ * \brief The events timestamped by the profiler
+ * \note The boot phases are consecutive: a phase lasts until the next phase
+ *       event or until the PROFILE_READY event. A page-map iteration lasts
+ *       until the next page-map event or until the PROFILE_MAP_END event,
+ *       and is only counted.
+ */
+enum profile_event
+{
+	PROFILE_BOOT,			/*!< Entry of the root partition */
+	PROFILE_INIT_PAGING,		/*!< Pip_InitPaging call */
+	PROFILE_REGISTER_INTERRUPTS,	/*!< Interrupt contexts and handlers */
+	PROFILE_BOOTSTRAP,		/*!< Child partitions bootstrap */
+	PROFILE_READY,			/*!< End of the last boot phase */
+	PROFILE_MAP_PAGE,		/*!< One page-map iteration */
+	PROFILE_MAP_END			/*!< End of the page-map iterations */
+};
+
+void profileMark(enum profile_event event);
+
+void profileDump(const char *revision);
+
+#endif /* __DEF_PROFILE_H__ */
@@ -0,0 +1,269 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains a single-producer single-consumer message ring, shared
+ * between the root partition and a child partition. It is included by both
+ * of them, and only depends on the compiler.
+ *
+ * The head and the tail are free-running indices, each written by one side
+ * only: the producer publishes the messages by moving the tail once they are
+ * written, the consumer releases their slots by moving the head once they
+ * are read. The x86 memory model keeps the stores and the loads of each side
+ * in order, so a compiler barrier is enough.
+ */
+
+#ifndef __DEF_RING_H__
+#define __DEF_RING_H__
+
+#include <stdint.h>
+
+/*!
+ * \def RING_SLOTS
+ * \brief The number of message slots of a ring, a power of two
+ */
+#define RING_SLOTS	128
+
+/*!
+ * \def RING_PAD_WORDS
+ * \brief The padding keeping the head and the tail in distinct cache lines
+ */
+#define RING_PAD_WORDS	15
+
+/*!
+ * \def CHANNEL_VADDR
+ * \brief The child address of the channel pages: the root to child ring,
+ *        the child to root ring, then the console of the child
+ * \note The channel ends at 0xffffa000, below the page Pip maps the boot
+ *       informations at in the root partition, BOOTINFO_VADDR.
+ */
+#define CHANNEL_VADDR	0xffff7000
+
+/*!
+ * \def CHANNEL_PAGES
+ * \brief The number of pages of the channel
+ */
+#define CHANNEL_PAGES	3
+
+/*!
+ * \def CHANNEL_TO_CHILD
+ * \brief The root to child ring, as seen by the child
+ */
+#define CHANNEL_TO_CHILD	((struct ring*) CHANNEL_VADDR)
+
+/*!
+ * \def CHANNEL_TO_ROOT
+ * \brief The child to root ring, as seen by the child
+ */
+#define CHANNEL_TO_ROOT		((struct ring*) (CHANNEL_VADDR + 0x1000))
+
+/*!
+ * \def CHANNEL_CONSOLE
+ * \brief The console of the child, as seen by the child, see console.h
+ */
+#define CHANNEL_CONSOLE		((struct console*) (CHANNEL_VADDR + 0x2000))
+
+/*!
+ * \def CHANNEL_MSG_HELLO
+ * \brief Message sent by the root once the child is bootstrapped, its first
+ *        argument being the index of the child
+ */
+#define CHANNEL_MSG_HELLO	1
+
+/*!
+ * \def CHANNEL_IDLE_VECTOR
+ * \brief The vector of its parent a child yields to when it has no work
+ *        left, saving its context into its VIDT[49]: the child is resumed
+ *        after the yield on the next interrupt served by the parent, and the
+ *        yield returns at once when the parent does not serve the vector
+ */
+#define CHANNEL_IDLE_VECTOR	64
+
+/*!
+ * \def RING_BARRIER()
+ * \brief Keep the compiler from moving memory accesses across it
+ */
+#define RING_BARRIER()	__asm__ __volatile__("" ::: "memory")
+
+/*!
+ * \struct ring_msg
+ * \brief A message of a ring
+ */
+struct ring_msg
+{
+	uint32_t type;		/*!< The message type */
+	uint32_t args[3];	/*!< The message arguments */
+};
+
+/*!
+ * \struct ring
+ * \brief A message ring, filling less than a page
+ */
+struct ring
+{
+	volatile uint32_t head;		/*!< Next slot read by the consumer */
+	uint32_t headPad[RING_PAD_WORDS];
+	volatile uint32_t tail;		/*!< Next slot written by the producer */
+	uint32_t tailPad[RING_PAD_WORDS];
+	struct ring_msg slots[RING_SLOTS];	/*!< The message slots */
+};
+
+/*!
+ * \fn static inline void ringInit(struct ring *ring)
+ * \brief Empty a ring, before it is shared
+ * \param ring The ring
+ */
+static inline void ringInit(struct ring *ring)
+{
+	ring->head = 0;
+	ring->tail = 0;
+}
+
+/*!
+ * \fn static inline uint32_t ringCount(struct ring *ring)
+ * \brief Count the messages waiting in a ring
+ * \param ring The ring
+ * \return The number of messages
+ */
+static inline uint32_t ringCount(struct ring *ring)
+{
+	return ring->tail - ring->head;
+}
+
+/*!
+ * \fn static inline void ringCopy(struct ring_msg *dst,
+ *		const struct ring_msg *src)
+ * \brief Copy a message word by word, no memcpy being available
+ * \param dst The destination message
+ * \param src The source message
+ */
+static inline void ringCopy(struct ring_msg *dst, const struct ring_msg *src)
+{
+	dst->type    = src->type;
+	dst->args[0] = src->args[0];
+	dst->args[1] = src->args[1];
+	dst->args[2] = src->args[2];
+}
+
+/*!
+ * \fn static inline uint32_t ringPushBatch(struct ring *ring,
+ *		const struct ring_msg *msgs, uint32_t count)
+ * \brief Write messages into a ring, publishing them at once
+ * \param ring The ring
+ * \param msgs The messages
+ * \param count The number of messages
+ * \return The number of messages written, less than count if the ring is
+ *         full
+ */
+static inline uint32_t ringPushBatch(struct ring *ring,
+		const struct ring_msg *msgs, uint32_t count)
+{
+	uint32_t tail = ring->tail;
+	uint32_t free = RING_SLOTS - (tail - ring->head);
+
+	if (count > free)
+	{
+		count = free;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		ringCopy(&ring->slots[(tail + i) & (RING_SLOTS - 1)], &msgs[i]);
+	}
+
+	RING_BARRIER();
+	ring->tail = tail + count;
+
+	return count;
+}
+
+/*!
+ * \fn static inline uint32_t ringPopBatch(struct ring *ring,
+ *		struct ring_msg *msgs, uint32_t count)
+ * \brief Read messages from a ring, releasing their slots at once
+ * \param ring The ring
+ * \param msgs The buffer receiving the messages
+ * \param count The maximum number of messages read
+ * \return The number of messages read
+ */
+static inline uint32_t ringPopBatch(struct ring *ring, struct ring_msg *msgs,
+		uint32_t count)
+{
+	uint32_t head  = ring->head;
+	uint32_t ready = ring->tail - head;
+
+	if (count > ready)
+	{
+		count = ready;
+	}
+
+	RING_BARRIER();
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		ringCopy(&msgs[i], &ring->slots[(head + i) & (RING_SLOTS - 1)]);
+	}
+
+	RING_BARRIER();
+	ring->head = head + count;
+
+	return count;
+}
+
+/*!
+ * \fn static inline uint32_t ringPush(struct ring *ring,
+ *		const struct ring_msg *msg)
+ * \brief Write a message into a ring
+ * \param ring The ring
+ * \param msg The message
+ * \return 1 if the message was written, 0 if the ring is full
+ */
+static inline uint32_t ringPush(struct ring *ring, const struct ring_msg *msg)
+{
+	return ringPushBatch(ring, msg, 1);
+}
+
+/*!
+ * \fn static inline uint32_t ringPop(struct ring *ring, struct ring_msg *msg)
+ * \brief Read a message from a ring
+ * \param ring The ring
+ * \param msg The buffer receiving the message
+ * \return 1 if a message was read, 0 if the ring is empty
+ */
+static inline uint32_t ringPop(struct ring *ring, struct ring_msg *msg)
+{
+	return ringPopBatch(ring, msg, 1);
+}
+
+#endif /* __DEF_RING_H__ */
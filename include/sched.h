@@ -0,0 +1,107 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the scheduler of the root partition
+ */
+
+#ifndef __DEF_SCHED_H__
+#define __DEF_SCHED_H__
+
+#include <stdint.h>
+
+#include "partitions.h"
+
+/*!
+ * \def SCHED_PRIORITIES
+ * \brief The number of priorities, 0 being the lowest
+ */
+#define SCHED_PRIORITIES	8
+
+/*!
+ * \def SCHED_DEFAULT_BUDGET
+ * \brief The timer ticks per epoch of a child with no budget option
+ */
+#define SCHED_DEFAULT_BUDGET	10
+
+/*!
+ * \def SCHED_NONE
+ * \brief No child partition, ending a run queue
+ */
+#define SCHED_NONE		0xffffffff
+
+/*!
+ * \def SCHED_QUEUED
+ * \brief The child is in a run queue
+ */
+#define SCHED_QUEUED		0
+
+/*!
+ * \def SCHED_SLEEPING
+ * \brief The child has no work until it is woken up
+ */
+#define SCHED_SLEEPING		1
+
+/*!
+ * \struct sched_array
+ * \brief The run queues of one epoch, a queue per priority
+ */
+struct sched_array
+{
+	uint32_t bitmap;			/*!< The non-empty queues */
+	uint32_t head[SCHED_PRIORITIES];	/*!< First child of each queue */
+	uint32_t tail[SCHED_PRIORITIES];	/*!< Last child of each queue */
+};
+
+void schedInit(struct partition *partitions, uint32_t count);
+
+uint32_t schedPick(void);
+
+void schedCharge(uint64_t entryCycles);
+
+void schedTick(void);
+
+uint32_t schedKeep(void);
+
+void schedSleep(uint32_t index);
+
+void schedWakeAll(void);
+
+uint32_t schedInterrupted(void);
+
+uint32_t schedRunnable(void);
+
+void printSchedStats(void);
+
+#endif /* __DEF_SCHED_H__ */
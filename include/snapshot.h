@@ -0,0 +1,91 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the child restart from a snapshot
+ * taken right after the bootstrap
+ */
+
+#ifndef __DEF_SNAPSHOT_H__
+#define __DEF_SNAPSHOT_H__
+
+#include <stdint.h>
+
+#include <pip/paging.h>
+#include <pip/vidt.h>
+
+#include "partitions.h"
+
+/*!
+ * \struct snapshot_page
+ * \brief A writable page of a child and its pristine copy
+ */
+struct snapshot_page
+{
+	uint32_t page;	/*!< The page mapped into the child */
+	uint32_t copy;	/*!< The copy taken after the bootstrap */
+};
+
+/*!
+ * \struct snapshot
+ * \brief The snapshot of a child, held in one page
+ */
+struct snapshot
+{
+	user_ctx_t context;		/*!< The initial context of the child */
+	uint32_t count;			/*!< The number of writable pages */
+	uint32_t restarts;		/*!< The number of restarts */
+	uint32_t restoredPages;		/*!< Pages restored over the restarts */
+	uint64_t restartCycles;		/*!< Cycles spent in the restarts */
+	struct snapshot_page pages[];	/*!< The writable pages */
+};
+
+/*!
+ * \def SNAPSHOT_MAX_PAGES
+ * \brief The maximum number of writable pages of a child with a snapshot
+ */
+#define SNAPSHOT_MAX_PAGES	((PAGE_SIZE - sizeof(struct snapshot)) / \
+		sizeof(struct snapshot_page))
+
+void snapshotBegin(struct partition *partition);
+
+void snapshotAdd(uint32_t page);
+
+uint32_t snapshotEnd(struct partition *partition, uint32_t keep);
+
+uint32_t snapshotRestore(struct partition *partition);
+
+void printSnapshotStats(const struct partition *partition, uint32_t index);
+
+#endif /* __DEF_SNAPSHOT_H__ */
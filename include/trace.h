@@ -0,0 +1,122 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations of the interrupt latency tracer
+ */
+
+#ifndef __DEF_TRACE_H__
+#define __DEF_TRACE_H__
+
+#include <stdint.h>
+
+/*!
+ * \def TRACE_SLOTS
+ * \brief The number of records of the trace ring, a power of two
+ */
+#define TRACE_SLOTS		256
+
+/*!
+ * \def TRACE_VECTORS
+ * \brief The number of vectors whose latencies are kept in histograms
+ */
+#define TRACE_VECTORS		8
+
+/*!
+ * \def TRACE_BUCKETS
+ * \brief The number of buckets of a latency histogram, bucket k counting
+ *        the latencies from 2^k to 2^(k+1)-1 cycles
+ */
+#define TRACE_BUCKETS		32
+
+/*!
+ * \def TRACE_PRINT_TICKS
+ * \brief The number of timer ticks between two prints of the histograms
+ */
+#define TRACE_PRINT_TICKS	256
+
+/*!
+ * \struct trace_record
+ * \brief The latencies of one interrupt served by the root partition
+ */
+struct trace_record
+{
+	uint32_t vector;	/*!< The vector of the interrupt */
+	uint32_t entry;		/*!< The low word of the time stamp counter at
+				     the entry stub */
+	uint32_t handler;	/*!< Cycles from the entry to the handler, 0
+				     for an interrupt forwarded to a child */
+	uint32_t resume;	/*!< Cycles from the entry to the yield
+				     resuming a child */
+};
+
+/*!
+ * \struct trace_ring
+ * \brief The lock-free ring of the trace records, written by the interrupt
+ *        path and drained into the histograms
+ */
+struct trace_ring
+{
+	volatile uint32_t head;	/*!< Next record drained */
+	volatile uint32_t tail;	/*!< Next record written */
+	struct trace_record records[TRACE_SLOTS]; /*!< The records */
+};
+
+/*!
+ * \struct trace_histogram
+ * \brief The latency histograms of a vector
+ */
+struct trace_histogram
+{
+	uint32_t vector;			/*!< The vector */
+	uint32_t count;				/*!< Interrupts drained */
+	uint32_t handled;			/*!< Interrupts drained which
+						     ran the root handler */
+	uint32_t maxHandler;			/*!< Longest entry to handler */
+	uint32_t maxResume;			/*!< Longest entry to resume */
+	uint32_t handler[TRACE_BUCKETS];	/*!< Entry to handler */
+	uint32_t resume[TRACE_BUCKETS];		/*!< Entry to resume */
+};
+
+void traceEntry(uint32_t vector, uint64_t entryCycles);
+
+void traceHandler(void);
+
+void traceResume(void);
+
+void traceTick(void);
+
+void printTraceStats(void);
+
+#endif /* __DEF_TRACE_H__ */
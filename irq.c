@@ -0,0 +1,267 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the interrupt dispatch registry of the root partition.
+ * Each registered vector gets its own context and stack page, and enters
+ * the root through its stub of irqstubs.S, which calls irqDispatch. A
+ * delegated vector is forwarded to the current child before the root handler
+ * is considered, so that the root does not serve it. The latencies of each
+ * interrupt are recorded by the tracer of trace.c, and its entry charges
+ * the cycles of the interrupted child to the scheduler of sched.c and ends
+ * the idle loop of idle.c.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/paging.h>
+#include <pip/vidt.h>
+
+#include "launcher.h"
+#include "cycles.h"
+#include "idle.h"
+#include "irq.h"
+#include "pool.h"
+#include "sched.h"
+#include "trace.h"
+
+/*!
+ * \brief The entry stubs, one every IRQ_STUB_SIZE bytes
+ * \note This symbol is defined in the irqstubs.S file
+ */
+extern void irqStubs(void);
+
+/*!
+ * \brief The registered handlers, indexed by vector
+ */
+static struct irq_entry irqTable[IRQ_VECTORS];
+
+/*!
+ * \brief The function resuming the partitions once a handler returned
+ */
+static void (*irqResume)(void);
+
+/*!
+ * \brief The function forwarding the delegated vectors to the children
+ */
+static irq_forward_t irqForward;
+
+/*!
+ * \brief The number of dispatched interrupts when the statistics were last
+ *        printed
+ */
+static uint32_t printedCount;
+
+/*!
+ * \fn void irqInit(void (*resume)(void), irq_forward_t forward)
+ * \brief Initialize the dispatch registry
+ * \param resume The function called once a handler returned, it must not
+ *        return itself and calls traceResume before yielding to a child
+ * \param forward The function forwarding the delegated vectors
+ */
+void irqInit(void (*resume)(void), irq_forward_t forward)
+{
+	irqResume  = resume;
+	irqForward = forward;
+}
+
+/*!
+ * \fn uint32_t irqRegister(uint32_t vector, irq_handler_t handler)
+ * \brief Register a handler for a VIDT vector
+ * \param vector The vector
+ * \param handler The handler
+ * \return 1 in the case of a success, 0 otherwise
+ * \note The context and the stack page are allocated on the first
+ *       registration of the vector and kept when its handler is replaced.
+ */
+uint32_t irqRegister(uint32_t vector, irq_handler_t handler)
+{
+	if (vector >= IRQ_VECTORS)
+	{
+		return 0;
+	}
+
+	struct irq_entry *entry = &irqTable[vector];
+
+	if (!entry->context)
+	{
+		uint32_t category = poolSetCategory(POOL_STACK);
+
+		entry->context = Pip_AllocContext();
+		entry->stack   = (uint32_t) poolAllocPage();
+
+		poolSetCategory(category);
+
+		if (!entry->context || !entry->stack)
+		{
+			return 0;
+		}
+
+		Pip_RegisterInterrupt(entry->context, vector,
+				(uint32_t) irqStubs + vector * IRQ_STUB_SIZE,
+				entry->stack, 0);
+	}
+
+	entry->handler = handler;
+
+	return 1;
+}
+
+/*!
+ * \fn void irqDelegate(uint32_t vector)
+ * \brief Forward a registered vector to the current child before its handler
+ * \param vector The vector
+ * \note The handler is still called when the current child does not take the
+ *       vector.
+ */
+void irqDelegate(uint32_t vector)
+{
+	if (vector < IRQ_VECTORS)
+	{
+		irqTable[vector].delegated = 1;
+	}
+}
+
+/*!
+ * \fn static uint32_t irqAccount(struct irq_entry *entry, uint64_t start)
+ * \brief Account the cycles spent by the root for an interrupt
+ * \param entry The registry entry of the vector
+ * \param start The time stamp of the entry of the dispatcher
+ * \return The cycles accounted
+ */
+static uint32_t irqAccount(struct irq_entry *entry, uint64_t start)
+{
+	uint32_t cycles = (uint32_t) (readCycles() - start);
+
+	entry->cycles += cycles;
+
+	if (cycles > entry->maxCycles)
+	{
+		entry->maxCycles = cycles;
+	}
+
+	return cycles;
+}
+
+/*!
+ * \fn void irqDispatch(uint64_t entryCycles, uint32_t vector)
+ * \brief Dispatch an interrupt to its handler, called by the entry stubs
+ * \param entryCycles The time stamp counter read by the entry stub
+ * \param vector The vector the interrupt was triggered on
+ * \note The record of the interrupt is written by the forward or resume
+ *       function, right before it yields to a child.
+ */
+void irqDispatch(uint64_t entryCycles, uint32_t vector)
+{
+	uint64_t start = readCycles();
+	struct irq_entry *entry = &irqTable[vector];
+
+	schedCharge(entryCycles);
+	idleWake(vector, entryCycles);
+	traceEntry(vector, entryCycles);
+
+	if (!entry->handler)
+	{
+		printf("No handler registered for the vector %d ...\n", vector);
+		PANIC();
+	}
+
+	entry->count++;
+
+	if (entry->delegated)
+	{
+		// The cycles are accounted before the yield, as the forward
+		// only returns once the child yielded back to the root
+		uint32_t cycles = irqAccount(entry, start);
+		entry->forwarded++;
+
+		if (irqForward(vector))
+		{
+			irqResume();
+		}
+
+		// The current child does not take the vector, the handler
+		// accounts the whole interrupt
+		entry->cycles -= cycles;
+		entry->forwarded--;
+	}
+
+	traceHandler();
+	entry->handler(vector);
+	irqAccount(entry, start);
+
+	irqResume();
+
+	// Should never be reached
+	PANIC();
+}
+
+/*!
+ * \fn void printIrqStats(void)
+ * \brief Print the interrupt counters of the registered vectors if
+ *        interrupts were dispatched since the last time they were printed
+ */
+void printIrqStats(void)
+{
+	uint32_t count = 0;
+
+	for (uint32_t vector = 0; vector < IRQ_VECTORS; vector++)
+	{
+		count += irqTable[vector].count;
+	}
+
+	if (count == printedCount)
+	{
+		return;
+	}
+
+	printedCount = count;
+
+	for (uint32_t vector = 0; vector < IRQ_VECTORS; vector++)
+	{
+		struct irq_entry *entry = &irqTable[vector];
+
+		if (!entry->count)
+		{
+			continue;
+		}
+
+		printf("Vector %d ... %d interrupts (%d forwarded, "
+				"average %d cycles, max %d cycles)\n",
+				vector, entry->count, entry->forwarded,
+				averageCycles(entry->cycles, entry->count),
+				entry->maxCycles);
+	}
+}
@@ -0,0 +1,230 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the demand paging of the read-only pages of child
+ * images: they are mapped by the page fault handler of the root partition
+ * on first access
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/paging.h>
+#include <pip/wrappers.h>
+
+#include "cycles.h"
+#include "lazy.h"
+#include "map.h"
+#include "partitions.h"
+#include "pool.h"
+
+/*!
+ * \brief The counters of the page faults served
+ */
+static struct lazy_stats lazyStats;
+
+/*!
+ * \brief The number of faults served when the counters were last printed
+ */
+static uint32_t printedFaults;
+
+/*!
+ * \fn static enum map_page_wrapper_ret_e mapLazyPage(
+ *		struct partition *partition, uint32_t index)
+ * \brief Map one lazy page of a child partition
+ * \param partition The child partition
+ * \param index The index of the page in the image
+ * \return The same codes as Pip_MapPageWrapper
+ */
+static enum map_page_wrapper_ret_e mapLazyPage(struct partition *partition,
+		uint32_t index)
+{
+	enum map_page_wrapper_ret_e rcode;
+
+	uint32_t offset = index * PAGE_SIZE;
+
+	rcode = mapPreparedPage(partition->descriptor,
+			partition->image->start + offset,
+			partition->image->loadAddress + offset,
+			partition->lazyFlags, &partition->mapStats);
+
+	if (rcode == SUCCESS)
+	{
+		partition->lazyBitmap[index / 32] |= 1 << (index % 32);
+	}
+
+	return rcode;
+}
+
+/*!
+ * \fn enum map_page_wrapper_ret_e lazyMapReadOnly(
+ *		struct partition *partition, uint32_t readOnlySize,
+ *		uint32_t flags)
+ * \brief Map the read-only pages of a child image on demand
+ * \param partition The partition being bootstrapped
+ * \param readOnlySize The size of the read-only part of the image
+ * \param flags The MAP_* flags used to map the read-only pages
+ * \return The same codes as Pip_MapPageWrapper
+ * \note The page tables of the whole read-only part are prepared, but only
+ *       its first page, holding the entry point, is mapped. The pages past
+ *       LAZY_MAX_PAGES are mapped eagerly.
+ */
+enum map_page_wrapper_ret_e lazyMapReadOnly(struct partition *partition,
+		uint32_t readOnlySize, uint32_t flags)
+{
+	enum map_page_wrapper_ret_e rcode;
+
+	uint32_t pages      = readOnlySize / PAGE_SIZE;
+	uint32_t lazyPages  = pages < LAZY_MAX_PAGES ? pages : LAZY_MAX_PAGES;
+	uint32_t lazySize   = lazyPages * PAGE_SIZE;
+
+	if (!lazyPages)
+	{
+		return SUCCESS;
+	}
+
+	partition->lazyBitmap = poolAllocZeroedPage();
+
+	if (!partition->lazyBitmap)
+	{
+		return FAIL_ALLOC_PAGE;
+	}
+
+	partition->lazyFlags = flags;
+	partition->lazyPages = lazyPages;
+
+	rcode = prepareRange(partition->descriptor,
+			partition->image->loadAddress, lazySize,
+			&partition->mapStats);
+
+	if (rcode != SUCCESS)
+	{
+		return rcode;
+	}
+
+	rcode = mapLazyPage(partition, 0);
+
+	if (rcode != SUCCESS)
+	{
+		return rcode;
+	}
+
+	return mapRange(partition->descriptor,
+			partition->image->start + lazySize,
+			readOnlySize - lazySize,
+			partition->image->loadAddress + lazySize,
+			flags, &partition->mapStats);
+}
+
+/*!
+ * \fn uint32_t lazyServeFault(struct partition *partition)
+ * \brief Serve a page fault of a child partition
+ * \param partition The faulting child partition
+ * \return The number of pages mapped, 0 if the fault was not caused by a
+ *         lazy page
+ * \note The faulting address is not known by the root partition: the page
+ *       of the saved instruction pointer is mapped if it is a lazy one,
+ *       which serves instruction fetches. Otherwise the fault is a data
+ *       access to a read-only page and all the remaining lazy pages are
+ *       mapped.
+ */
+uint32_t lazyServeFault(struct partition *partition)
+{
+	uint64_t start  = readCycles();
+	uint32_t mapped = 0;
+
+	if (!partition->lazyPages)
+	{
+		return 0;
+	}
+
+	uint32_t offset = partition->context->eip -
+		partition->image->loadAddress;
+	uint32_t index  = offset / PAGE_SIZE;
+
+	if (offset < partition->lazyPages * PAGE_SIZE &&
+			!(partition->lazyBitmap[index / 32] & 1 << (index % 32)))
+	{
+		if (mapLazyPage(partition, index) == SUCCESS)
+		{
+			mapped++;
+		}
+	}
+	else
+	{
+		for (index = 0; index < partition->lazyPages; index++)
+		{
+			if (partition->lazyBitmap[index / 32] & 1 << (index % 32))
+			{
+				continue;
+			}
+
+			if (mapLazyPage(partition, index) != SUCCESS)
+			{
+				break;
+			}
+
+			mapped++;
+		}
+	}
+
+	if (mapped)
+	{
+		lazyStats.faults++;
+		lazyStats.mappedPages += mapped;
+		lazyStats.cycles      += readCycles() - start;
+	}
+
+	return mapped;
+}
+
+/*!
+ * \fn void printLazyStats(void)
+ * \brief Print the page fault counters if faults were served since the last
+ *        time they were printed
+ */
+void printLazyStats(void)
+{
+	if (lazyStats.faults == printedFaults)
+	{
+		return;
+	}
+
+	printedFaults = lazyStats.faults;
+
+	printf("Faults served ... %d (%d pages, average %d cycles)\n",
+			lazyStats.faults, lazyStats.mappedPages,
+			averageCycles(lazyStats.cycles, lazyStats.faults));
+}
@@ -0,0 +1,304 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the decompression of the compressed child images,
+ * page by page into the pages mapped into the child
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/paging.h>
+#include <pip/wrappers.h>
+
+#include "lz4.h"
+#include "map.h"
+#include "partitions.h"
+#include "pool.h"
+#include "profile.h"
+
+/*!
+ * \fn static uint32_t readLength(const uint8_t **in, const uint8_t *end,
+ *		uint32_t length)
+ * \brief Read the extra bytes of a literal or match length
+ * \param in The read cursor, updated
+ * \param end The end of the block
+ * \param length The length read from the token
+ * \return The full length, 0xffffffff if the block is truncated
+ */
+static uint32_t readLength(const uint8_t **in, const uint8_t *end,
+		uint32_t length)
+{
+	uint8_t byte;
+
+	if (length != 15)
+	{
+		return length;
+	}
+
+	do
+	{
+		if (*in >= end)
+		{
+			return 0xffffffff;
+		}
+
+		byte    = *(*in)++;
+		length += byte;
+	} while (byte == 255);
+
+	return length;
+}
+
+/*!
+ * \fn static uint32_t decompressBlock(const uint8_t *in, uint32_t size,
+ *		uint8_t *out)
+ * \brief Decompress a LZ4 block into a page
+ * \param in The compressed block
+ * \param size The size of the compressed block
+ * \param out The page where to decompress the block
+ * \return The size of the decompressed data, 0xffffffff if the block is
+ *         corrupted or does not fit in a page
+ */
+static uint32_t decompressBlock(const uint8_t *in, uint32_t size,
+		uint8_t *out)
+{
+	const uint8_t *end = in + size;
+	uint8_t *start     = out;
+	uint8_t *outEnd    = out + PAGE_SIZE;
+
+	while (in < end)
+	{
+		uint32_t token  = *in++;
+		uint32_t length = readLength(&in, end, token >> 4);
+
+		if (length > (uint32_t) (end - in) ||
+				length > (uint32_t) (outEnd - out))
+		{
+			return 0xffffffff;
+		}
+
+		for (uint32_t i = 0; i < length; i++)
+		{
+			*out++ = *in++;
+		}
+
+		// The last sequence only holds literals
+		if (in == end)
+		{
+			break;
+		}
+
+		if (end - in < 2)
+		{
+			return 0xffffffff;
+		}
+
+		uint32_t offset = in[0] | in[1] << 8;
+		in += 2;
+
+		length = readLength(&in, end, token & 15);
+
+		if (length == 0xffffffff || !offset ||
+				offset > (uint32_t) (out - start) ||
+				length > (uint32_t) (outEnd - out) - 4 ||
+				outEnd - out < 4)
+		{
+			return 0xffffffff;
+		}
+
+		// The match may overlap the bytes it produces
+		const uint8_t *match = out - offset;
+
+		for (length += 4; length > 0; length--)
+		{
+			*out++ = *match++;
+		}
+	}
+
+	return out - start;
+}
+
+/*!
+ * \fn const struct lz4_image_header *lz4ImageHeader(
+ *		const struct child_image *image)
+ * \brief Retrieve the header of a compressed child image
+ * \param image The compressed child image
+ * \return The header of the image, 0 if it is not a compressed image or if
+ *         its block sizes table or its blocks overrun the image
+ * \note The blocks are bounded here once, so that lz4MapPages never reads
+ *       past a truncated image or boot module.
+ */
+const struct lz4_image_header *lz4ImageHeader(const struct child_image *image)
+{
+	const struct lz4_image_header *header =
+		(const struct lz4_image_header*) image->start;
+	uint32_t available = image->imageEnd - image->start;
+
+	if (available < sizeof(struct lz4_image_header) ||
+			header->magic != LZ4_IMAGE_MAGIC ||
+			header->imageSize > ~(PAGE_SIZE - 1))
+	{
+		return 0;
+	}
+
+	uint32_t pages = (header->imageSize + PAGE_SIZE - 1) / PAGE_SIZE;
+
+	available -= sizeof(struct lz4_image_header);
+
+	if (pages > available / sizeof(uint32_t))
+	{
+		return 0;
+	}
+
+	available -= pages * sizeof(uint32_t);
+
+	for (uint32_t i = 0; i < pages; i++)
+	{
+		uint32_t blockSize = header->blockSizes[i] & ~LZ4_BLOCK_RAW;
+
+		if (blockSize > available)
+		{
+			return 0;
+		}
+
+		available -= blockSize;
+	}
+
+	return header;
+}
+
+/*!
+ * \fn enum map_page_wrapper_ret_e lz4MapPages(struct partition *partition,
+ *		uint32_t offset, uint32_t size, uint32_t flags)
+ * \brief Decompress pages of a compressed child image into newly allocated
+ *        pages and map them into the child partition
+ * \param partition The partition being bootstrapped
+ * \param offset The page-aligned offset of the first page in the image
+ * \param size The size of the pages to map
+ * \param flags The MAP_* flags of the mapping, only MAP_WRITE is used
+ * \return The same codes as Pip_MapPageWrapper, FAIL_ALLOC_PAGE if a block
+ *         is corrupted
+ * \note Each page is decompressed right into the page mapped into the
+ *       child: the decompressed image is never held in a second copy.
+ */
+enum map_page_wrapper_ret_e lz4MapPages(struct partition *partition,
+		uint32_t offset, uint32_t size, uint32_t flags)
+{
+	enum map_page_wrapper_ret_e rcode;
+
+	const struct lz4_image_header *header = lz4ImageHeader(partition->image);
+	struct map_stats *stats = &partition->mapStats;
+
+	uint32_t loadAddress = partition->image->loadAddress;
+	uint32_t pages       = (header->imageSize + PAGE_SIZE - 1) / PAGE_SIZE;
+	uint32_t first       = offset / PAGE_SIZE;
+
+	rcode = prepareRange(partition->descriptor, loadAddress + offset, size,
+			stats);
+
+	if (rcode != SUCCESS)
+	{
+		return rcode;
+	}
+
+	// Skip the blocks of the pages before the range
+	const uint8_t *block = (const uint8_t*) &header->blockSizes[pages];
+
+	for (uint32_t i = 0; i < first; i++)
+	{
+		block += header->blockSizes[i] & ~LZ4_BLOCK_RAW;
+	}
+
+	for (uint32_t i = first; i < first + size / PAGE_SIZE; i++)
+	{
+		profileMark(PROFILE_MAP_PAGE);
+
+		uint32_t blockSize = header->blockSizes[i] & ~LZ4_BLOCK_RAW;
+		uint32_t page      = (uint32_t) poolAllocPage();
+		uint32_t length;
+
+		if (!page)
+		{
+			return FAIL_ALLOC_PAGE;
+		}
+
+		if (header->blockSizes[i] & LZ4_BLOCK_RAW)
+		{
+			uint8_t *out = (uint8_t*) page;
+
+			length = blockSize <= PAGE_SIZE ? blockSize : 0xffffffff;
+
+			for (uint32_t j = 0; j < blockSize && j < PAGE_SIZE; j++)
+			{
+				out[j] = block[j];
+			}
+		}
+		else
+		{
+			length = decompressBlock(block, blockSize, (uint8_t*) page);
+		}
+
+		if (length == 0xffffffff)
+		{
+			printf("Corrupted compressed block of the page %d\n", i);
+			return FAIL_ALLOC_PAGE;
+		}
+
+		// The last page of the image is zero-padded
+		for (uint8_t *out = (uint8_t*) page + length;
+				out < (uint8_t*) page + PAGE_SIZE; out++)
+		{
+			*out = 0;
+		}
+
+		stats->decompressedPages++;
+
+		rcode = mapPreparedPage(partition->descriptor, page,
+				loadAddress + i * PAGE_SIZE, flags & MAP_WRITE,
+				stats);
+
+		if (rcode != SUCCESS)
+		{
+			return rcode;
+		}
+
+		block += blockSize;
+	}
+
+	profileMark(PROFILE_MAP_END);
+
+	return SUCCESS;
+}
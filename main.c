@@ -52,6 +52,20 @@
 #include <pip/wrappers.h>
 
 #include "launcher.h"
+#include "bench.h"
+#include "builder.h"
+#include "consoles.h"
+#include "fpu.h"
+#include "idle.h"
+#include "irq.h"
+#include "lazy.h"
+#include "modules.h"
+#include "partitions.h"
+#include "pool.h"
+#include "profile.h"
+#include "sched.h"
+#include "snapshot.h"
+#include "trace.h"
 
 /*!
  * \brief Start address of the root partition
@@ -78,41 +92,186 @@ extern void *__startChildAddress;
 extern void *__endChildAddress;
 
 /*!
- * \brief The child partition descriptor
+ * \brief The child partitions launched by the root partition
  */
-uint32_t descChild;
+static struct partition partitions[MAX_PARTITIONS];
+
+/*!
+ * \brief The builder of the child partitions, with the default layout
+ */
+static struct builder builder;
+
+/*!
+ * \brief The index of the child partition elected by the scheduler
+ */
+static uint32_t currentPartition;
 
 /*
  * Function prototypes
  */
-static uint32_t bootstrapPartition(uint32_t base, uint32_t size,
-		uint32_t loadAddress);
 static void printBootInformations(pip_fpinfo* bootInformations);
+static void printCapacity(void);
+#ifndef LAUNCHER_BENCH
+static void restartPartition(struct partition *partition);
+#endif
 static void doBootstrap(void);
+#ifndef LAUNCHER_BENCH
+static uint32_t forwardInterrupt(uint32_t vector);
+#endif
+static uint32_t idleWork(void);
 static void doYield(void);
 
+#ifndef LAUNCHER_BENCH
 /*!
+ * \fn void timerHandler(uint32_t vector)
  * \brief Handler for the timer interrupt
+ * \param vector The vector the interrupt was triggered on
  */
-void timerHandler(void)
+static void timerHandler(uint32_t vector)
 {
-	printf("A timer interrupt was triggered ...\n");
+	CONSOLE_PRINTF(&rootConsole, "A timer interrupt was triggered ...\n");
+	printLazyStats();
 
-	// Yield to the child partition
-	doYield();
+	// Account the work of the child whose time slice ends, if the tick
+	// interrupted one, and write the buffered messages to the serial port
+	uint32_t interrupted = schedInterrupted();
 
-	// Should never be reached
-	PANIC();
+	if (interrupted != SCHED_NONE)
+	{
+		consoleEndSlice(&partitions[interrupted], interrupted);
+	}
+
+	consolesDrain(partitions, builder.count);
+
+	// Refill the stock of zeroed pages while the children run
+	poolZeroIdle();
+
+	// Move the interrupt latencies into their histograms
+	traceTick();
+
+	// Charge the tick to the interrupted child partition, the idle
+	// children having work again
+	schedTick();
+	schedWakeAll();
+}
+
+/*!
+ * \fn void idleHandler(uint32_t vector)
+ * \brief Handler for the idle vector, to which the current child partition
+ *        yields when it has no work left
+ * \param vector The vector the child yielded to
+ * \note The child is out of the run queues until the next timer or
+ *       keyboard interrupt.
+ */
+static void idleHandler(uint32_t vector)
+{
+	partitions[currentPartition].idleYields++;
+	schedSleep(currentPartition);
+}
+
+/*!
+ * \fn void faultHandler(uint32_t vector)
+ * \brief Handler for the page fault exception of the child partitions
+ * \param vector The vector the exception was triggered on
+ * \note The faulting instruction is resumed once the handler returned.
+ */
+static void faultHandler(uint32_t vector)
+{
+	struct partition *partition = &partitions[currentPartition];
+
+	// Map the lazy pages needed by the faulting child, taken from its
+	// cache colors as at bootstrap
+	poolSetOwner(POOL_OWNER(currentPartition));
+	poolSetColors(partition->image->colors);
+	uint32_t mapped = lazyServeFault(partition);
+	poolSetOwner(POOL_ROOT);
+	poolSetColors(0);
+
+	if (!mapped)
+	{
+		printf("Unexpected page fault in the child %d (%s) at 0x%x ...\n",
+				currentPartition, partition->image->name,
+				partition->context->eip);
+		restartPartition(partition);
+	}
 }
 
 /*!
+ * \fn void crashHandler(uint32_t vector)
+ * \brief Handler for the exceptions a child partition cannot recover from
+ * \param vector The vector the exception was triggered on
+ * \note The child is restarted once the handler returned.
+ */
+static void crashHandler(uint32_t vector)
+{
+	struct partition *partition = &partitions[currentPartition];
+
+	printf("Exception %d in the child %d (%s) at 0x%x ...\n", vector,
+			currentPartition, partition->image->name,
+			partition->context->eip);
+	restartPartition(partition);
+}
+
+/*!
+ * \fn void keyboardHandler(uint32_t vector)
  * \brief Handler for the keyboard interrupt
+ * \param vector The vector the interrupt was triggered on
  */
-void keyboardHandler(void)
+static void keyboardHandler(uint32_t vector)
 {
-	printf("A keyboard interrupt was triggered ...\n");
-	for (;;);
+	CONSOLE_PRINTF(&rootConsole, "A keyboard interrupt was triggered ...\n");
+	printIrqStats();
+	printTraceStats();
+	printIdleStats(partitions, builder.count);
+	printSchedStats();
+	printFpuStats();
+
+	for (uint32_t i = 0; i < builder.count; i++)
+	{
+		printConsoleStats(&partitions[i], i);
+		printSnapshotStats(&partitions[i], i);
+	}
+
+	printCapacity();
+	schedWakeAll();
+}
+
+/*!
+ * \fn static uint32_t forwardInterrupt(uint32_t vector)
+ * \brief Forward a delegated interrupt to the current child partition
+ * \param vector The vector the interrupt was triggered on
+ * \return 1 if the child took the interrupt and yielded back to the root,
+ *         0 if the root handler must serve the interrupt
+ */
+static uint32_t forwardInterrupt(uint32_t vector)
+{
+	struct partition *partition = &partitions[currentPartition];
+
+	if (vector != TIMER_VECTOR || !(partition->image->flags & CHILD_TIMER))
+	{
+		return 0;
+	}
+
+	// The timer handler takes the tick back once the child used up its
+	// budget, or when a child of higher priority may run
+	if (!schedKeep())
+	{
+		return 0;
+	}
+
+	traceResume();
+
+	// The timer handler charges the tick when the yield fails
+	if (Pip_Yield(partition->descriptor, vector, 49, 0, 0) != 0)
+	{
+		return 0;
+	}
+
+	schedTick();
+
+	return 1;
 }
+#endif
 
 /*!
  * \fn void _main(pip_fpinfo* bootInformations)
@@ -124,11 +283,13 @@ void keyboardHandler(void)
  */
 void _main(pip_fpinfo* bootInformations)
 {
+	profileMark(PROFILE_BOOT);
+
 	printf("The root partition is booting ...\n");
 
 	// Retrieve the root partition context from the stack top
-	user_ctx_t *rootPartitionContext = (user_ctx_t*) (STACK_TOP_VADDR + PAGE_SIZE -
-			sizeof(user_ctx_t));
+	user_ctx_t *rootPartitionContext = (user_ctx_t*) (BUILDER_STACK_VADDR +
+			PAGE_SIZE - sizeof(user_ctx_t));
 
 	// Save the context pointer of the root partition into the VIDT
 	VIDT[48] = rootPartitionContext;
@@ -142,31 +303,87 @@ void _main(pip_fpinfo* bootInformations)
 
 	printBootInformations(bootInformations);
 
+	// Keep the boot modules out of the memory given to the kernel
+	uint32_t memoryBegin = modulesScan(bootInformations->membegin,
+			bootInformations->memend);
+
+	printf("Boot modules ... %d\n", modulesCount());
+
 	printf("Initializing the memory pages ...\n");
-	if (!Pip_InitPaging(bootInformations->membegin,
-			bootInformations->memend))
+	profileMark(PROFILE_INIT_PAGING);
+	if (!Pip_InitPaging(memoryBegin, bootInformations->memend))
 	{
 		PANIC();
 	}
 
-	// Allocate two interrupt contexts
-	user_ctx_t *timerHandlerContext    = Pip_AllocContext();
-	user_ctx_t *keyboardHandlerContext = Pip_AllocContext();
-
-	// Allocate a page for the handler stack
-	uint32_t handlerStackAddress = (uint32_t) Pip_AllocPage();
+	printf("Initializing the page pool ...\n");
+	if (!poolInit(memoryBegin, bootInformations->memend))
+	{
+		PANIC();
+	}
 
-	// Registration of the interrupt handler
-	Pip_RegisterInterrupt(timerHandlerContext, 32, (uint32_t) timerHandler,
-			handlerStackAddress, 0);
+#ifdef LAUNCHER_BENCH
+	// The interrupt handlers are not registered while benchmarking, as
+	// they would yield to the children behind the benchmarks' back
+	printf("Benchmarking the Pip calls ...\n");
+	benchPipCalls();
+
+	printf("Benchmarking the FPU state switches ...\n");
+	benchFpu();
+#else
+	// Register the interrupt handlers, each vector getting its own
+	// context and stack page, as a fault may be raised while a child is
+	// serving an interrupt
+	profileMark(PROFILE_REGISTER_INTERRUPTS);
+	irqInit(doYield, forwardInterrupt);
+	if (!irqRegister(TIMER_VECTOR, timerHandler) ||
+	    !irqRegister(KEYBOARD_VECTOR, keyboardHandler) ||
+	    !irqRegister(CHANNEL_IDLE_VECTOR, idleHandler) ||
+	    !irqRegister(PAGE_FAULT_VECTOR, faultHandler) ||
+	    !irqRegister(INVALID_OPCODE_VECTOR, crashHandler) ||
+	    !irqRegister(GENERAL_PROTECTION_VECTOR, crashHandler))
+	{
+		printf("Failed to register the interrupt handlers ...\n");
+		PANIC();
+	}
 
-	Pip_RegisterInterrupt(keyboardHandlerContext, 33, (uint32_t) keyboardHandler,
-			handlerStackAddress, 0);
+	// The timer is served by the children taking it
+	irqDelegate(TIMER_VECTOR);
+#endif
 
-	printf("Bootstraping the minimal partition ...");
+	printf("Bootstraping the child partitions ...\n");
+	profileMark(PROFILE_BOOTSTRAP);
 	doBootstrap();
 
+	profileMark(PROFILE_READY);
+	profileDump(bootInformations->revision);
+
+#ifdef LAUNCHER_BENCH
+	printf("Benchmarking the yield to the child partition ...\n");
+	benchYield(partitions[0].descriptor);
+
+	printf("Benchmarking the channel to the child partition ...\n");
+	benchRing(partitions[0].descriptor, partitions[0].toChild,
+			partitions[0].toRoot);
+
+	printf("Benchmarking the page grants to the child partition ...\n");
+	benchGrant(&partitions[0]);
+
+	printf("Benchmarking the nested launchers ...\n");
+	for (uint32_t i = 0; i < builder.count && i < BENCH_NESTING_DEPTHS; i++)
+	{
+		benchNesting(&partitions[i], i + 1);
+	}
+
+	printf("Benchmarking the restart of the child partition ...\n");
+	benchRestart(&partitions[0]);
+
+	printf("BENCH done\n");
+	for (;;);
+#endif
+
 	printf("Yielding to the child partition ...\n");
+	schedInit(partitions, builder.count);
 	doYield();
 
 	// Should never be reached.
@@ -188,217 +405,159 @@ static void printBootInformations(pip_fpinfo* bootInformations)
 	printf("Root partition end ... 0x%x\n", &__endReadOnlyAddress);
 	printf("Child address start ... 0x%x\n", &__startChildAddress);
 	printf("Child address end ... 0x%x\n", &__endChildAddress);
+	printf("Child images ... %d\n", __childImagesCount);
 }
 
+#ifndef LAUNCHER_BENCH
 /*!
- * \fn static void bootstrapPartition(uint32_t base, uint32_t size,
- *		uint32_t loadAddress)
- * \brief Bootstraping a new child partition at a specific address
- * \param base The start address of the first memory page
- * \param size The size of the child partition to map
- * \param laddr The address where to load the partition
- * \return 0 in the case of a success, greater than zero otherwise
+ * \fn static void restartPartition(struct partition *partition)
+ * \brief Restart a misbehaving child from its snapshot, abort if it has none
+ * \param partition The child partition
+ * \note The child runs again from its entry point once resumed.
  */
-static uint32_t bootstrapPartition(uint32_t base, uint32_t size,
-		uint32_t loadAddress)
+static void restartPartition(struct partition *partition)
 {
-	enum map_page_wrapper_ret_e map_page_rcode;
-
-	// Allocate 5 memory pages in order to create a child partition
-	descChild                = (uint32_t) Pip_AllocPage();
-	uint32_t pdChild         = (uint32_t) Pip_AllocPage();
-	uint32_t shadow1Child    = (uint32_t) Pip_AllocPage();
-	uint32_t shadow2Child    = (uint32_t) Pip_AllocPage();
-	uint32_t configPagesList = (uint32_t) Pip_AllocPage();
-
-	// Create the child partition
-	if (!Pip_CreatePartition(descChild, pdChild, shadow1Child, shadow2Child,
-			configPagesList))
+	uint32_t index = partition - partitions;
+
+	if (!partition->snapshot)
 	{
-		return FAIL_CREATE_PARTITION;
+		printf("The child %d has no snapshot to restart from ...\n",
+				index);
+		PANIC();
 	}
 
-	// Map each page of the child partition to the newly created partition
-	for (uint32_t offset = 0; offset < size; offset += PAGE_SIZE)
+	uint32_t restored = snapshotRestore(partition);
+
+	printf("Child %d restarted, %d pages restored\n", index, restored);
+	builderSendHello(partition, index);
+}
+#endif
+
+/*!
+ * \fn static void printCapacity(void)
+ * \brief Print the pages held by the root and the child partitions, and how
+ *        many more children like each of them would fit in the memory left
+ * \note A child holds the pages of its image, stack, VIDT, kernel
+ *       structures and channel, and of its restart snapshot. The count of
+ *       children fitting is based on the peak pages of each child, the
+ *       embedded image pages mapped in place not being counted.
+ */
+static void printCapacity(void)
+{
+	uint32_t freePages = poolFreePages();
+	uint32_t freeSlots = MAX_PARTITIONS - builder.count;
+
+	printf("Pages of the root ... ");
+	printPoolAccount(poolAccount(POOL_ROOT));
+
+	for (uint32_t i = 0; i < builder.count; i++)
 	{
-		map_page_rcode = Pip_MapPageWrapper(base + offset, descChild,
-                                                    loadAddress + offset);
-		switch (map_page_rcode) {
-			case FAIL_ALLOC_PAGE:
-				printf("MapPageWrapper failed while allocating a page\n");
-				return FAIL_MAP_CHILD_PAGE;
-			case FAIL_PREPARE:
-				printf("MapPageWrapper failed while trying to give pages to the kernel for memory data structures\n");
-				return FAIL_MAP_CHILD_PAGE;
-			case FAIL_ADD_VADDR:
-				printf("MapPageWrapper failed while trying to add a memory page to the child\n");
-				return FAIL_MAP_CHILD_PAGE;
-			case SUCCESS :
-				break;
-			default:
-				printf("Unknown MapPageWrapper return code\n");
-		}
+		printf("Pages of the child %d (%s) ... ", i,
+				partitions[i].image->name);
+		printPoolAccount(poolAccount(POOL_OWNER(i)));
 	}
 
-	// Allocate a page for the child's stack
-	uint32_t stackPage = (uint32_t) Pip_AllocPage();
-
-	// Compute the physical address of the child context
-	user_ctx_t *contextPAddr = (user_ctx_t*) (stackPage + PAGE_SIZE -
-			sizeof(user_ctx_t));
-
-	// Compute the virtual address of the child context
-	user_ctx_t *contextVAddr = (user_ctx_t*) (STACK_TOP_VADDR + PAGE_SIZE -
-			sizeof(user_ctx_t));
-
-	// Create the child's context
-	contextPAddr->valid    = 0;
-	contextPAddr->eip      = loadAddress;
-	contextPAddr->pipflags = 0;
-	contextPAddr->eflags   = 0x202;
-	contextPAddr->regs.ebp = STACK_TOP_VADDR + PAGE_SIZE;
-	contextPAddr->regs.esp = contextPAddr->regs.ebp - sizeof(user_ctx_t);
-	contextPAddr->valid    = 1;
-
-	// Map the stack page to the newly created partition
-        map_page_rcode = Pip_MapPageWrapper(stackPage, descChild, STACK_TOP_VADDR);
-        switch (map_page_rcode) {
-                case FAIL_ALLOC_PAGE:
-                        printf("MapPageWrapper failed while allocating a page\n");
-                        return FAIL_MAP_STACK_PAGE;
-                case FAIL_PREPARE:
-                        printf("MapPageWrapper failed while trying to give pages to the kernel for memory data structures\n");
-                        return FAIL_MAP_STACK_PAGE;
-                case FAIL_ADD_VADDR:
-                        printf("MapPageWrapper failed while trying to add a memory page to the child\n");
-                        return FAIL_MAP_STACK_PAGE;
-                case SUCCESS :
-                        break;
-                default:
-                        printf("Unknown MapPageWrapper return code\n");
-        }
-
-	// Allocate a memory page for the child's VIDT
-	user_ctx_t **vidtPage = (user_ctx_t**) Pip_AllocPage();
-
-	// Save the child's context into the child's VIDT
-	vidtPage[ 0] = contextVAddr;
-	vidtPage[48] = contextVAddr;
-	vidtPage[49] = contextVAddr;
-
-	// Map the VIDT page to the newly created partition
-        map_page_rcode = Pip_MapPageWrapper((uint32_t) vidtPage, descChild, VIDT_VADDR);
-        switch (map_page_rcode) {
-                case FAIL_ALLOC_PAGE:
-                        printf("MapPageWrapper failed while allocating a page\n");
-                        return FAIL_MAP_VIDT_PAGE;
-                case FAIL_PREPARE:
-                        printf("MapPageWrapper failed while trying to give pages to the kernel for memory data structures\n");
-                        return FAIL_MAP_VIDT_PAGE;
-                case FAIL_ADD_VADDR:
-                        printf("MapPageWrapper failed while trying to add a memory page to the child\n");
-                        return FAIL_MAP_VIDT_PAGE;
-                case SUCCESS :
-                        break;
-                default:
-                        printf("Unknown MapPageWrapper return code\n");
-        }
-
-	return 0;
+	printf("Pages of all the partitions ... ");
+	printPoolAccount(poolTotals());
+
+	printf("Free pages ... %d, free partition slots ... %d\n",
+			freePages, freeSlots);
+
+	for (uint32_t i = 0; i < builder.count; i++)
+	{
+		uint32_t pages = poolAccount(POOL_OWNER(i))->peakTotal;
+		uint32_t fit   = pages ? freePages / pages : 0;
+
+		printf("Capacity for the child %d (%s) ... %d more of %d "
+				"pages (%d bytes of image)\n", i,
+				partitions[i].image->name,
+				fit < freeSlots ? fit : freeSlots, pages,
+				partitions[i].image->end -
+				partitions[i].image->start);
+	}
 }
 
 /*!
  * \fn static void doBootstrap(void)
- * \brief Do the bootstrap of the child partition and abort if an error occured.
+ * \brief Do the bootstrap of every child partition listed in the partition
+ *        manifest or passed as a boot module. A child that fails to
+ *        bootstrap is torn down and skipped, abort if none succeeded.
  */
 static void doBootstrap(void)
 {
-	// Retrieve the start and end address of the child partition
-	uint32_t startChildAddress = (uint32_t) &__startChildAddress;
-	uint32_t endChildAddress   = (uint32_t) &__endChildAddress;
+	static const struct builder_layout layout = BUILDER_LAYOUT_DEFAULT;
+
+	uint32_t imagesCount = __childImagesCount + modulesCount();
 
-	// Bootstrap the child partition
-	uint32_t ret = bootstrapPartition(startChildAddress, endChildAddress -
-			startChildAddress, LOAD_VADDRESS);
+	if (imagesCount > MAX_PARTITIONS)
+	{
+		printf("Too many child images: %d, the maximum is %d ...\n",
+				imagesCount, MAX_PARTITIONS);
+		PANIC();
+	}
+
+	// The children are restarted from a snapshot when they misbehave
+	builderInit(&builder, &layout, partitions, MAX_PARTITIONS,
+			BUILDER_SNAPSHOT);
 
-	switch (ret)
+	for (uint32_t i = 0; i < imagesCount; i++)
 	{
-		case 0: return;
-		case FAIL_CREATE_PARTITION:
-			printf("bootstrapPartition returned "
-					"FAIL_CREATE_PARTITION ...\n");
-			break;
-		case FAIL_MAP_CHILD_PAGE:
-			printf("bootstrapPartition returned "
-					"FAIL_MAP_CHILD_PAGE ...\n");
-			break;
-		case FAIL_MAP_STACK_PAGE:
-			printf("bootstrapPartition returned "
-					"FAIL_MAP_STACK_PAGE ...\n");
-			break;
-		case FAIL_MAP_VIDT_PAGE:
-			printf("bootstrapPartition returned "
-					"FAIL_MAP_VIDT_PAGE ...\n");
-			break;
-		default:
-			printf("bootstrapPartition returned "
-				"an unexpected value: %d ...\n", ret);
+		// The embedded images come before the boot modules
+		if (i < __childImagesCount)
+		{
+			builderLaunch(&builder, &__childImages[i]);
+		}
+		else
+		{
+			builderLaunch(&builder,
+					modulesImage(i - __childImagesCount));
+		}
 	}
 
-	PANIC();
+	printPoolStats();
+	printCapacity();
+
+	if (!builder.count)
+	{
+		printf("No child partition could be bootstrapped ...\n");
+		PANIC();
+	}
+}
+
+/*!
+ * \fn static uint32_t idleWork(void)
+ * \brief Do the background work of the root partition while no child
+ *        partition has work
+ * \return 0 once there is no background work left
+ */
+static uint32_t idleWork(void)
+{
+	consolesDrain(partitions, builder.count);
+
+	return poolZeroIdle();
 }
 
 /*!
  * \fn static void doYield(void)
- * \brief Do the yield to the child partition and abort if an error occured.
+ * \brief Do the yield to the child partition elected by the scheduler, and
+ *        abort if an error occured. The root partition waits for the next
+ *        interrupt when no child has work.
  */
 static void doYield(void)
 {
-	uint32_t ret = Pip_Yield(descChild, 0, 49, 0, 0);
+	traceResume();
 
-	switch (ret)
+	uint32_t next = schedPick();
+
+	// A single child with work is not preempted, unless it takes the timer
+	idleTimer(schedRunnable() > 1 || (next != SCHED_NONE &&
+			(partitions[next].image->flags & CHILD_TIMER)));
+
+	if (next == SCHED_NONE)
 	{
-		case 0: return;
-		case FAIL_INVALID_INT_LEVEL:
-			printf("Pip_Yield returned "
-					"FAIL_INVALID_INT_LEVEL ...\n");
-			break;
-		case FAIL_INVALID_CTX_SAVE_INDEX:
-			printf("Pip_Yield returned "
-					"FAIL_INVALID_CTX_SAVE_INDEX ...\n");
-			break;
-		case FAIL_ROOT_CALLER:
-			printf("Pip_Yield returned "
-					"FAIL_ROOT_CALLER ...\n");
-			break;
-		case FAIL_INVALID_CHILD:
-			printf("Pip_Yield returned "
-					"FAIL_INVALID_CHILD ...\n");
-			break;
-		case FAIL_UNAVAILABLE_TARGET_VIDT:
-			printf("Pip_Yield returned "
-					"FAIL_UNAVAILABLE_TARGET_VIDT ...\n");
-			break;
-		case FAIL_UNAVAILABLE_CALLER_VIDT:
-			printf("Pip_Yield returned "
-					"FAIL_UNAVAILABLE_CALLER_VIDT ...\n");
-			break;
-		case FAIL_MASKED_INTERRUPT:
-			printf("Pip_Yield returned "
-					"FAIL_MASKED_INTERRUPT ...\n");
-			break;
-		case FAIL_UNAVAILABLE_TARGET_CTX:
-			printf("Pip_Yield returned "
-					"FAIL_UNAVAILABLE_TARGET_CTX ...\n");
-			break;
-		case FAIL_CALLER_CONTEXT_SAVE:
-			printf("Pip_Yield returned "
-					"FAIL_CALLER_CONTEXT_SAVE ...\n");
-			break;
-		default:
-			printf("Pip_Yield returned an unexpected value: "
-					"0x%x ...\n", ret);
+		idleEnter(idleWork);
 	}
 
-	PANIC();
+	currentPartition = next;
+	builderYield(&partitions[currentPartition]);
 }
@@ -0,0 +1,250 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the range mapping functions used to map a contiguous
+ * memory area into a child partition with as few Pip calls as possible
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/paging.h>
+#include <pip/api.h>
+#include <pip/wrappers.h>
+
+#include "map.h"
+#include "pageops.h"
+#include "pool.h"
+#include "profile.h"
+#include "snapshot.h"
+
+/*!
+ * \fn enum map_page_wrapper_ret_e prepareRange(uint32_t descChild,
+ *		uint32_t loadAddress, uint32_t size, struct map_stats *stats)
+ * \brief Give the kernel all the pages it needs to map a virtual range
+ * \param descChild The child partition descriptor
+ * \param loadAddress The first virtual address of the range in the child
+ * \param size The size of the range
+ * \param stats The counters to update
+ * \return SUCCESS, FAIL_ALLOC_PAGE or FAIL_PREPARE
+ * \note Pip_CountToMap is only called once per page table: every page of
+ *       the same page table shares the kernel structures prepared for the
+ *       first one
+ */
+enum map_page_wrapper_ret_e prepareRange(uint32_t descChild,
+		uint32_t loadAddress, uint32_t size, struct map_stats *stats)
+{
+	enum map_page_wrapper_ret_e rcode = SUCCESS;
+
+	uint32_t offset   = 0;
+	uint32_t category = poolSetCategory(POOL_PREPARE);
+
+	while (rcode == SUCCESS && offset < size)
+	{
+		uint32_t vaddr = loadAddress + offset;
+		uint32_t count = Pip_CountToMap(descChild, vaddr);
+		stats->kernelCalls++;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t page = (uint32_t) poolAllocZeroedPage();
+
+			if (!page)
+			{
+				rcode = FAIL_ALLOC_PAGE;
+				break;
+			}
+
+			stats->kernelCalls++;
+			stats->prepareCalls++;
+
+			if (!Pip_Prepare(descChild, vaddr, page))
+			{
+				rcode = FAIL_PREPARE;
+				break;
+			}
+
+			stats->preparePages++;
+		}
+
+		// Jump to the first address covered by the next page table, the
+		// offset not wrapping around at the top of the address space
+		offset += PAGE_TABLE_SPAN - (vaddr & (PAGE_TABLE_SPAN - 1));
+	}
+
+	poolSetCategory(category);
+
+	return rcode;
+}
+
+/*!
+ * \fn enum map_page_wrapper_ret_e mapPreparedPage(uint32_t descChild,
+ *		uint32_t source, uint32_t vaddr, uint32_t flags,
+ *		struct map_stats *stats)
+ * \brief Map one page into a child partition whose page table is prepared
+ * \param descChild The child partition descriptor
+ * \param source The address of the source page
+ * \param vaddr The address where to map the page in the child
+ * \param flags The MAP_* flags of the mapping
+ * \param stats The counters to update
+ * \return SUCCESS, FAIL_ALLOC_PAGE or FAIL_ADD_VADDR
+ */
+enum map_page_wrapper_ret_e mapPreparedPage(uint32_t descChild,
+		uint32_t source, uint32_t vaddr, uint32_t flags,
+		struct map_stats *stats)
+{
+	uint32_t write = (flags & MAP_WRITE) ? 1 : 0;
+	uint32_t page  = source;
+
+	if (flags & MAP_SHARE)
+	{
+		stats->kernelCalls++;
+
+		if (Pip_AddVAddr(source, descChild, vaddr, 1, write, 1))
+		{
+			stats->mappedPages++;
+			return SUCCESS;
+		}
+
+		// The page is already mapped in another child: copy it
+		flags |= MAP_COPY;
+	}
+
+	if (flags & MAP_ZERO)
+	{
+		page = (uint32_t) poolAllocZeroedPage();
+
+		if (!page)
+		{
+			return FAIL_ALLOC_PAGE;
+		}
+
+		stats->zeroedPages++;
+	}
+	else if (flags & MAP_COPY)
+	{
+		page = (uint32_t) poolAllocPage();
+
+		if (!page)
+		{
+			return FAIL_ALLOC_PAGE;
+		}
+
+		copyPage(page, source);
+		stats->copiedPages++;
+	}
+
+	stats->kernelCalls++;
+
+	if (!Pip_AddVAddr(page, descChild, vaddr, 1, write, 1))
+	{
+		return FAIL_ADD_VADDR;
+	}
+
+	stats->mappedPages++;
+
+	// Keep the writable pages in the snapshot of the child
+	if (write)
+	{
+		snapshotAdd(page);
+	}
+
+	return SUCCESS;
+}
+
+/*!
+ * \fn enum map_page_wrapper_ret_e mapRange(uint32_t descChild,
+ *		uint32_t base, uint32_t size, uint32_t loadAddress,
+ *		uint32_t flags, struct map_stats *stats)
+ * \brief Map a contiguous memory area into a child partition
+ * \param descChild The child partition descriptor
+ * \param base The start address of the first memory page
+ * \param size The size of the area to map
+ * \param loadAddress The address where to map the area in the child
+ * \param flags The MAP_* flags of the mapping
+ * \param stats The counters to update
+ * \return The same codes as Pip_MapPageWrapper
+ * \note The page tables of the whole range are prepared up front, then the
+ *       pages are added page table by page table. This costs one
+ *       Pip_AddVAddr call per page instead of the Pip_CountToMap and
+ *       Pip_AddVAddr pair issued by Pip_MapPageWrapper for every page.
+ */
+enum map_page_wrapper_ret_e mapRange(uint32_t descChild, uint32_t base,
+		uint32_t size, uint32_t loadAddress, uint32_t flags,
+		struct map_stats *stats)
+{
+	enum map_page_wrapper_ret_e rcode;
+
+	rcode = prepareRange(descChild, loadAddress, size, stats);
+
+	if (rcode != SUCCESS)
+	{
+		return rcode;
+	}
+
+	for (uint32_t offset = 0; offset < size; offset += PAGE_SIZE)
+	{
+		profileMark(PROFILE_MAP_PAGE);
+
+		rcode = mapPreparedPage(descChild, base + offset, loadAddress + offset,
+				flags, stats);
+
+		if (rcode != SUCCESS)
+		{
+			return rcode;
+		}
+	}
+
+	profileMark(PROFILE_MAP_END);
+
+	return SUCCESS;
+}
+
+/*!
+ * \fn void printMapStats(const struct map_stats *stats)
+ * \brief Print the range mapping counters to the serial link
+ * \param stats The counters to print
+ */
+void printMapStats(const struct map_stats *stats)
+{
+	printf("Mapped pages ... %d\n", stats->mappedPages);
+	printf("Kernel calls ... %d (per-page wrapper: at least %d)\n",
+			stats->kernelCalls, 2 * stats->mappedPages);
+	printf("Prepare calls ... %d\n", stats->prepareCalls);
+	printf("Pages consumed by the kernel ... %d\n", stats->preparePages);
+	printf("Copied pages ... %d\n", stats->copiedPages);
+	printf("Zeroed pages ... %d\n", stats->zeroedPages);
+	printf("Decompressed pages ... %d\n", stats->decompressedPages);
+}
@@ -37,6 +37,43 @@
  */
 
 #include <pip/stdio.h>
+#include <pip/paging.h>
+#include <pip/vidt.h>
+#include <pip/api.h>
+
+#include "bench.h"
+#include "builder.h"
+#include "console.h"
+#include "cycles.h"
+#include "ring.h"
+
+#ifdef MINIMAL_PINGPONG
+/*!
+ * \brief The stack of the handler of the forwarded vector
+ */
+static uint8_t forwardStack[PAGE_SIZE] __attribute__((aligned(16)));
+
+/*!
+ * \brief The initial context of the handler of the forwarded vector
+ */
+static user_ctx_t forwardContext;
+
+/*!
+ * \fn static void forwardHandler(void)
+ * \brief Handler of the vector forwarded by the nesting benchmark, which
+ *        yields straight back to the parent forwarding it
+ * \note Saving its context into the slot of the vector, the next forwarded
+ *       vector resumes the loop.
+ */
+static void forwardHandler(void)
+{
+	for (;;)
+	{
+		Pip_Yield(0, BENCH_FORWARD_SAVE_INDEX, BENCH_FORWARD_VECTOR,
+				0, 0);
+	}
+}
+#endif
 
 /*!
  * \fn void _main(void)
@@ -47,10 +84,53 @@
  */
 void _main(void)
 {
-	printf("Hello World!\n");
+#ifdef MINIMAL_PINGPONG
+	static struct ring_msg msgs[RING_SLOTS];
+
+	builderInitContext(&forwardContext, (uint32_t) forwardHandler,
+			(uint32_t) forwardStack + sizeof(forwardStack));
+
+	VIDT[BENCH_FORWARD_VECTOR] = &forwardContext;
+
+	// Echo the messages of the root partition, then resume it where it
+	// yielded, with interrupt 49 and saving our context into our VIDT
+	for (;;)
+	{
+		uint32_t count = ringPopBatch(CHANNEL_TO_CHILD, msgs, RING_SLOTS);
+		ringPushBatch(CHANNEL_TO_ROOT, msgs, count);
+
+		Pip_Yield(0, 49, 49, 0, 0);
+	}
+#endif
+
+	struct ring_msg msg;
+
+	// Mark the first output with the low word of the time stamp counter,
+	// for the boot time measured by tools/harness.sh
+	CONSOLE_PRINTF(CHANNEL_CONSOLE, "FIRST tsc=%x\n",
+			(uint32_t) readCycles());
+
+	CONSOLE_PRINTF(CHANNEL_CONSOLE, "Hello World!\n");
 
 	for (;;)
 	{
-		printf("Woken up!\n");
+		CONSOLE_PRINTF(CHANNEL_CONSOLE, "Woken up!\n");
+
+		while (ringPop(CHANNEL_TO_CHILD, &msg))
+		{
+			if (msg.type == CHANNEL_MSG_HELLO)
+			{
+				CONSOLE_PRINTF(CHANNEL_CONSOLE,
+						"I am the child %d\n",
+						msg.args[0]);
+			}
+		}
+
+		// Report a unit of work to the root partition
+		CHANNEL_CONSOLE->work++;
+
+		// Nothing left to do until the next interrupt: yield to the idle
+		// vector of the root partition, which resumes us after the yield
+		Pip_Yield(0, CHANNEL_IDLE_VECTOR, 49, 0, 0);
 	}
 }
@@ -0,0 +1,212 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the nested launcher source code: a child partition
+ * launching the image it embeds as its own child, with the partition
+ * builder of the root partition. The nested launcher of depth NESTED_DEPTH
+ * launches the nested launcher of the depth below, down to minimal.bin at
+ * depth 1, see the Makefile.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/paging.h>
+#include <pip/vidt.h>
+#include <pip/api.h>
+
+#include "launcher.h"
+#include "bench.h"
+#include "builder.h"
+#include "partitions.h"
+#include "pool.h"
+
+/*!
+ * \def NESTED_ARENA_PAGES
+ * \brief The number of pages given to the page pool of the nested launcher,
+ *        which must hold the kernel structures, the stack, the VIDT, the
+ *        channel and the bss of the child, the arena of a nested child
+ *        included
+ */
+#define NESTED_ARENA_PAGES	(64 * (NESTED_DEPTH - 1))
+
+/*!
+ * \def NESTED_LOAD_VADDR
+ * \brief The child address of the embedded image
+ */
+#define NESTED_LOAD_VADDR	0x700000
+
+/*!
+ * \brief Start address of the embedded image
+ * \note This symbol is defined in the nested.ld file
+ */
+extern void *__startChildImage;
+
+/*!
+ * \brief End address of the content of the embedded image
+ * \note This symbol is defined in the nested.ld file
+ */
+extern void *__childImageEnd;
+
+/*!
+ * \brief Page-aligned end address of the embedded image
+ * \note This symbol is defined in the nested.ld file
+ */
+extern void *__endChildImage;
+
+/*!
+ * \brief The name of the embedded image
+ * \note This symbol is defined in the image.S file
+ */
+extern const char __childImageName[];
+
+/*!
+ * \brief The memory of the page pool, mapped as zeroed pages by the parent
+ */
+static uint8_t arena[NESTED_ARENA_PAGES * PAGE_SIZE]
+	__attribute__((aligned(PAGE_SIZE)));
+
+/*!
+ * \brief The image of the child
+ */
+static struct child_image image;
+
+/*!
+ * \brief The child partition
+ */
+static struct partition partitions[1];
+
+/*!
+ * \brief The builder of the child partition
+ */
+static struct builder builder;
+
+#ifdef MINIMAL_PINGPONG
+/*!
+ * \brief The stack of the handler of the forwarded vector
+ */
+static uint8_t forwardStack[PAGE_SIZE] __attribute__((aligned(16)));
+
+/*!
+ * \brief The initial context of the handler of the forwarded vector
+ */
+static user_ctx_t forwardContext;
+
+/*!
+ * \brief The context saved by the handler of the forwarded vector while
+ *        the child serves it
+ */
+static user_ctx_t forwardSave;
+
+/*!
+ * \fn static void forwardHandler(void)
+ * \brief Handler of the vector forwarded by the nesting benchmark, which
+ *        forwards it to the child and yields back to the parent once the
+ *        child yielded back
+ * \note Saving its context into the slot of the vector, the next forwarded
+ *       vector resumes the loop.
+ */
+static void forwardHandler(void)
+{
+	for (;;)
+	{
+		Pip_Yield(partitions[0].descriptor, BENCH_FORWARD_VECTOR,
+				BENCH_FORWARD_SAVE_INDEX, 0, 0);
+		Pip_Yield(0, BENCH_FORWARD_SAVE_INDEX, BENCH_FORWARD_VECTOR,
+				0, 0);
+	}
+}
+#endif
+
+/*!
+ * \fn void _main(void)
+ * \brief The nested launcher entry point called by the boot.S file
+ * \warning Do not name the entry point "main" because gcc generates an
+ *          erroneous machine code: it tries to retrieve the arguments argc
+ *          and argv even with the parameters --freestanding and -nostdlib
+ */
+void _main(void)
+{
+	static const struct builder_layout layout = BUILDER_LAYOUT_DEFAULT;
+
+	uint32_t begin = (uint32_t) arena;
+	uint32_t end   = begin + sizeof(arena);
+
+	printf("The nested launcher of depth %d is booting ...\n",
+			NESTED_DEPTH);
+
+	if (!Pip_InitPaging(begin, end) || !poolInit(begin, end))
+	{
+		PANIC();
+	}
+
+	image.name        = __childImageName;
+	image.start       = (uint32_t) &__startChildImage;
+	image.end         = (uint32_t) &__endChildImage;
+	image.imageEnd    = (uint32_t) &__childImageEnd;
+	image.loadAddress = NESTED_LOAD_VADDR;
+
+	// The child is not restarted, its snapshot would double the arena
+	builderInit(&builder, &layout, partitions, 1, 0);
+
+	if (!builderLaunch(&builder, &image))
+	{
+		PANIC();
+	}
+
+	printPoolStats();
+
+#ifdef MINIMAL_PINGPONG
+	builderInitContext(&forwardContext, (uint32_t) forwardHandler,
+			(uint32_t) forwardStack + sizeof(forwardStack));
+
+	VIDT[BENCH_FORWARD_VECTOR]     = &forwardContext;
+	VIDT[BENCH_FORWARD_SAVE_INDEX] = &forwardSave;
+
+	// Pass the yields of the parent down to the child, and its yields
+	// back up, for the round trips of the nesting benchmark
+	for (;;)
+	{
+		builderYield(&partitions[0]);
+		Pip_Yield(0, 49, 49, 0, 0);
+	}
+#endif
+
+	// Give the time slices of the parent to the child
+	for (;;)
+	{
+		builderYield(&partitions[0]);
+	}
+}
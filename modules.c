@@ -0,0 +1,177 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the discovery of the child images passed as boot
+ * modules. The bootloader loads the module directory written by
+ * tools/modpack at the start of the free memory, where the root partition
+ * looks for it before giving the rest of the memory to Pip_InitPaging.
+ * The images are then mapped in place, as the embedded ones, unless the
+ * directory is not page-aligned: their pages are copied in this case.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/paging.h>
+
+#include "launcher.h"
+#include "modules.h"
+#include "partitions.h"
+
+/*!
+ * \brief The child images found in the boot modules
+ */
+static struct child_image moduleImages[MAX_PARTITIONS];
+
+/*!
+ * \brief The number of child images found in the boot modules
+ */
+static uint32_t moduleImagesCount;
+
+/*!
+ * \fn static uint32_t validEntry(const struct module_directory *directory,
+ *		const struct module_entry *entry)
+ * \brief Check that an entry lies within its directory
+ * \param directory The module directory
+ * \param entry The entry to check
+ * \return 1 if the entry is valid, 0 otherwise
+ */
+static uint32_t validEntry(const struct module_directory *directory,
+		const struct module_entry *entry)
+{
+	uint32_t headerSize = sizeof(struct module_directory) +
+		directory->count * sizeof(struct module_entry);
+
+	return entry->name[MODULE_NAME_SIZE - 1] == '\0' &&
+		entry->offset >= headerSize &&
+		!(entry->offset & (PAGE_SIZE - 1)) &&
+		entry->size >= sizeof(struct image_layout) &&
+		entry->offset <= directory->size &&
+		entry->size <= directory->size - entry->offset;
+}
+
+/*!
+ * \fn uint32_t modulesScan(uint32_t memoryBegin, uint32_t memoryEnd)
+ * \brief Look for the boot module directory at the start of the free memory
+ *        and record the child images it holds
+ * \param memoryBegin The first address of the free memory
+ * \param memoryEnd The last address of the free memory
+ * \return The first address of the free memory left after the modules, to
+ *         be given to Pip_InitPaging
+ * \note This must be called before Pip_InitPaging, which would hand the
+ *       pages of the modules out. Reading the last page of an unaligned
+ *       image may cross the end of the directory, one more page is kept
+ *       in this case.
+ */
+uint32_t modulesScan(uint32_t memoryBegin, uint32_t memoryEnd)
+{
+	const struct module_directory *directory =
+		(const struct module_directory*) memoryBegin;
+
+	if (memoryEnd - memoryBegin < sizeof(struct module_directory) ||
+			directory->magic != MODULES_MAGIC)
+	{
+		return memoryBegin;
+	}
+
+	uint32_t unaligned = memoryBegin & (PAGE_SIZE - 1);
+	uint32_t modulesEnd = (memoryBegin + directory->size + PAGE_SIZE - 1) &
+		~(PAGE_SIZE - 1);
+
+	if (unaligned)
+	{
+		modulesEnd += PAGE_SIZE;
+	}
+
+	if (directory->count > MAX_PARTITIONS ||
+			directory->size > memoryEnd - memoryBegin ||
+			modulesEnd > memoryEnd)
+	{
+		printf("Invalid boot module directory, ignored ...\n");
+		return memoryBegin;
+	}
+
+	for (uint32_t i = 0; i < directory->count; i++)
+	{
+		const struct module_entry *entry = &directory->entries[i];
+
+		if (!validEntry(directory, entry))
+		{
+			printf("Invalid boot module %d, ignored ...\n", i);
+			continue;
+		}
+
+		struct child_image *image = &moduleImages[moduleImagesCount++];
+
+		image->name        = entry->name;
+		image->start       = memoryBegin + entry->offset;
+		image->imageEnd    = image->start + entry->size;
+		image->end         = image->start +
+			((entry->size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1));
+		image->loadAddress = entry->loadAddress;
+		image->flags       = entry->flags & ~CHILD_UNALIGNED;
+		image->colors      = entry->colors;
+		image->priority    = entry->priority;
+		image->budget      = entry->budget;
+
+		if (unaligned)
+		{
+			image->flags |= CHILD_UNALIGNED;
+		}
+	}
+
+	return modulesEnd;
+}
+
+/*!
+ * \fn uint32_t modulesCount(void)
+ * \brief Get the number of child images found in the boot modules
+ * \return The number of child images
+ */
+uint32_t modulesCount(void)
+{
+	return moduleImagesCount;
+}
+
+/*!
+ * \fn const struct child_image *modulesImage(uint32_t index)
+ * \brief Get a child image found in the boot modules
+ * \param index The index of the image, below modulesCount()
+ * \return The child image
+ */
+const struct child_image *modulesImage(uint32_t index)
+{
+	return &moduleImages[index];
+}
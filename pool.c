@@ -0,0 +1,720 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the page pool of the root partition. Every page handed
+ * to a child partition is allocated from the pool, which records its owner
+ * so that all the pages of a partition can be recycled when it is torn
+ * down. The pool keeps a stock of pages zeroed while the root is idle.
+ *
+ * The pages of a partition can be restricted to a set of cache colors, so
+ * that partitions given disjoint colors do not evict each other from the
+ * last-level cache. Pip_AllocPage gives no choice of page: the colored
+ * allocations take pages from it until one has a wanted color, setting the
+ * others aside for the next allocations.
+ * \note The root partition addresses the memory given to Pip_InitPaging
+ *       at its physical address, from which the color is computed.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/paging.h>
+
+#include "pageops.h"
+#include "pool.h"
+
+/*!
+ * \def OWNER_TABLE_PAGES
+ * \brief The number of pages of the owner table needed to cover 4 GiB
+ */
+#define OWNER_TABLE_PAGES	256
+
+/*!
+ * \def ACCOUNTS_PER_PAGE
+ * \brief The number of owner accounts held by a page of the account table
+ */
+#define ACCOUNTS_PER_PAGE	(PAGE_SIZE / sizeof(struct pool_account))
+
+/*!
+ * \def ACCOUNT_TABLE_PAGES
+ * \brief The number of pages of the account table, one account per owner
+ */
+#define ACCOUNT_TABLE_PAGES	((256 + ACCOUNTS_PER_PAGE - 1) / \
+		ACCOUNTS_PER_PAGE)
+
+/*!
+ * \brief The owner of each page of the memory given to Pip_InitPaging, one
+ *        byte per page, split in pages of the table
+ */
+static uint8_t *owners[OWNER_TABLE_PAGES];
+
+/*!
+ * \brief The pages held by each owner, split in pages of the table
+ */
+static struct pool_account *accounts[ACCOUNT_TABLE_PAGES];
+
+/*!
+ * \brief The pages held by all the owners
+ */
+static struct pool_account totals;
+
+/*!
+ * \brief The number of pages of the owner table
+ */
+static uint32_t ownerTablePages;
+
+/*!
+ * \brief The first address of the memory given to Pip_InitPaging
+ */
+static uint32_t memoryBegin;
+
+/*!
+ * \brief The number of pages of the memory given to Pip_InitPaging
+ */
+static uint32_t memoryPages;
+
+/*!
+ * \brief The owner of the pages allocated from now on
+ */
+static uint32_t currentOwner = POOL_ROOT;
+
+/*!
+ * \brief The category of the pages allocated from now on
+ */
+static uint32_t currentCategory = POOL_OTHER;
+
+/*!
+ * \brief The cache colors of the pages allocated from now on, 0 for any
+ */
+static uint32_t currentColors;
+
+/*!
+ * \brief The pages set aside by the colored allocations, by color, linked
+ *        through their first word
+ */
+static uint32_t *colorPages[POOL_COLORS];
+
+/*!
+ * \brief The number of pages set aside by the colored allocations
+ */
+static uint32_t colorCount;
+
+/*!
+ * \brief The color the next colored allocation starts looking from
+ */
+static uint32_t nextColor;
+
+/*!
+ * \brief The recycled pages, linked through their first word
+ */
+static uint32_t *dirtyPages;
+
+/*!
+ * \brief The number of recycled pages
+ */
+static uint32_t dirtyCount;
+
+/*!
+ * \brief The zeroed pages, linked through their first word
+ */
+static uint32_t *zeroedPages;
+
+/*!
+ * \brief The number of zeroed pages in stock
+ */
+static uint32_t zeroedCount;
+
+/*!
+ * \brief The counters of the pool
+ */
+static struct pool_stats poolStats;
+
+/*!
+ * \def OWNER(index)
+ * \brief The owner table entry of the page of this index
+ */
+#define OWNER(index)	owners[(index) / PAGE_SIZE][(index) % PAGE_SIZE]
+
+/*!
+ * \def ACCOUNT(owner)
+ * \brief The account table entry of this owner
+ */
+#define ACCOUNT(owner)	(&accounts[(owner) / ACCOUNTS_PER_PAGE] \
+		[(owner) % ACCOUNTS_PER_PAGE])
+
+/*!
+ * \fn static void setOwner(uint32_t *page, uint32_t owner)
+ * \brief Record the owner of a page
+ * \param page The page
+ * \param owner The owner of the page
+ */
+static void setOwner(uint32_t *page, uint32_t owner)
+{
+	uint32_t index = ((uint32_t) page - memoryBegin) / PAGE_SIZE;
+
+	if (index < memoryPages)
+	{
+		OWNER(index) = owner;
+	}
+}
+
+/*!
+ * \fn static void charge(struct pool_account *account)
+ * \brief Count a page of the current category allocated to an account
+ * \param account The account
+ */
+static void charge(struct pool_account *account)
+{
+	uint32_t live = ++account->live[currentCategory];
+
+	if (live > account->peak[currentCategory])
+	{
+		account->peak[currentCategory] = live;
+	}
+
+	if (++account->liveTotal > account->peakTotal)
+	{
+		account->peakTotal = account->liveTotal;
+	}
+}
+
+/*!
+ * \fn static void uncharge(struct pool_account *account, uint32_t category)
+ * \brief Count a page of a category no longer held by an account
+ * \param account The account
+ * \param category The pool_category the page was allocated in
+ */
+static void uncharge(struct pool_account *account, uint32_t category)
+{
+	account->live[category]--;
+	account->liveTotal--;
+}
+
+/*!
+ * \fn static void allocated(uint32_t *page)
+ * \brief Record a page allocated to the current owner
+ * \param page The page
+ */
+static void allocated(uint32_t *page)
+{
+	setOwner(page, currentOwner);
+	charge(ACCOUNT(currentOwner));
+	charge(&totals);
+}
+
+/*!
+ * \fn uint32_t poolInit(uint32_t begin, uint32_t end)
+ * \brief Initialize the pool, once Pip_InitPaging has been called
+ * \param begin The first address of the memory given to Pip_InitPaging
+ * \param end The last address of the memory given to Pip_InitPaging
+ * \return 1 in the case of a success, 0 otherwise
+ * \note The owner table takes one byte per page of the memory, and the
+ *       account table one account per owner, in pages allocated from
+ *       Pip_AllocPage.
+ */
+uint32_t poolInit(uint32_t begin, uint32_t end)
+{
+	uint32_t pages      = (end - begin) / PAGE_SIZE;
+	uint32_t tablePages = (pages + PAGE_SIZE - 1) / PAGE_SIZE;
+
+	for (uint32_t i = 0; i < tablePages; i++)
+	{
+		owners[i] = (uint8_t*) Pip_AllocPage();
+
+		if (!owners[i])
+		{
+			return 0;
+		}
+
+		zeroPage((uint32_t) owners[i]);
+	}
+
+	for (uint32_t i = 0; i < ACCOUNT_TABLE_PAGES; i++)
+	{
+		accounts[i] = (struct pool_account*) Pip_AllocPage();
+
+		if (!accounts[i])
+		{
+			return 0;
+		}
+
+		zeroPage((uint32_t) accounts[i]);
+	}
+
+	memoryBegin     = begin;
+	memoryPages     = pages;
+	ownerTablePages = tablePages;
+
+	for (uint32_t i = 0; i < tablePages; i++)
+	{
+		setOwner((uint32_t*) owners[i], POOL_ROOT);
+	}
+
+	for (uint32_t i = 0; i < ACCOUNT_TABLE_PAGES; i++)
+	{
+		setOwner((uint32_t*) accounts[i], POOL_ROOT);
+	}
+
+	return 1;
+}
+
+/*!
+ * \fn void poolSetOwner(uint32_t owner)
+ * \brief Set the owner of the pages allocated from now on
+ * \param owner POOL_ROOT or POOL_OWNER(index) of a child partition
+ */
+void poolSetOwner(uint32_t owner)
+{
+	currentOwner = owner;
+}
+
+/*!
+ * \fn uint32_t poolSetCategory(uint32_t category)
+ * \brief Set the category of the pages allocated from now on
+ * \param category A pool_category
+ * \return The previous category, to be set back by the caller
+ */
+uint32_t poolSetCategory(uint32_t category)
+{
+	uint32_t previous = currentCategory;
+
+	currentCategory = category;
+
+	return previous;
+}
+
+/*!
+ * \fn uint32_t poolSetColors(uint32_t colors)
+ * \brief Set the cache colors of the pages allocated from now on
+ * \param colors The mask of the colors, 0 for pages of any color
+ * \return The previous mask, to be set back by the caller
+ * \note The recycled pages and the zeroed stock only serve the allocations
+ *       without colors.
+ */
+uint32_t poolSetColors(uint32_t colors)
+{
+	uint32_t previous = currentColors;
+
+	currentColors = colors & POOL_ALL_COLORS;
+
+	return previous;
+}
+
+/*!
+ * \fn static uint32_t *takeColor(uint32_t colors)
+ * \brief Take a page set aside with one of the given colors
+ * \param colors The mask of the colors
+ * \return The page address, 0 if no page of these colors was set aside
+ * \note The colors are tried in turn, spreading the pages of a partition
+ *       over all its colors.
+ */
+static uint32_t *takeColor(uint32_t colors)
+{
+	for (uint32_t i = 0; i < POOL_COLORS; i++)
+	{
+		uint32_t color = (nextColor + i) % POOL_COLORS;
+		uint32_t *page = colorPages[color];
+
+		if (!(colors & (1U << color)) || !page)
+		{
+			continue;
+		}
+
+		colorPages[color] = (uint32_t*) page[0];
+		colorCount--;
+		nextColor = color + 1;
+
+		return page;
+	}
+
+	return 0;
+}
+
+/*!
+ * \fn static uint32_t *allocColored(uint32_t colors)
+ * \brief Allocate a page of one of the given colors
+ * \param colors The mask of the colors
+ * \return The page address, 0 if there is no page of these colors left
+ */
+static uint32_t *allocColored(uint32_t colors)
+{
+	uint32_t *page = takeColor(colors);
+
+	while (!page)
+	{
+		page = Pip_AllocPage();
+
+		if (!page)
+		{
+			return 0;
+		}
+
+		poolStats.fromPip++;
+
+		uint32_t color = POOL_COLOR((uint32_t) page);
+
+		if (!(colors & (1U << color)))
+		{
+			page[0]           = (uint32_t) colorPages[color];
+			colorPages[color] = page;
+			colorCount++;
+			poolStats.stashed++;
+			page = 0;
+		}
+	}
+
+	poolStats.colored++;
+
+	return page;
+}
+
+/*!
+ * \fn uint32_t *poolAllocPage(void)
+ * \brief Allocate a page for the current owner, its content is undefined
+ * \return The page address, 0 if there is no free page left
+ */
+uint32_t *poolAllocPage(void)
+{
+	uint32_t *page = dirtyPages;
+
+	if (currentColors)
+	{
+		page = allocColored(currentColors);
+
+		if (!page)
+		{
+			return 0;
+		}
+	}
+	else if (page)
+	{
+		dirtyPages = (uint32_t*) page[0];
+		dirtyCount--;
+	}
+	else if (zeroedPages)
+	{
+		page        = zeroedPages;
+		zeroedPages = (uint32_t*) page[0];
+		zeroedCount--;
+	}
+	else if (colorCount)
+	{
+		page = takeColor(POOL_ALL_COLORS);
+	}
+	else
+	{
+		page = Pip_AllocPage();
+
+		if (!page)
+		{
+			return 0;
+		}
+
+		poolStats.fromPip++;
+	}
+
+	allocated(page);
+
+	return page;
+}
+
+/*!
+ * \fn uint32_t *poolAllocZeroedPage(void)
+ * \brief Allocate a zeroed page for the current owner
+ * \return The page address, 0 if there is no free page left
+ * \note The page is taken from the stock zeroed while the root was idle.
+ *       It is only zeroed on request when the stock is empty.
+ */
+uint32_t *poolAllocZeroedPage(void)
+{
+	uint32_t *page = zeroedPages;
+
+	if (page && !currentColors)
+	{
+		zeroedPages = (uint32_t*) page[0];
+		zeroedCount--;
+		page[0] = 0;
+		poolStats.zeroedHits++;
+		allocated(page);
+
+		return page;
+	}
+
+	page = poolAllocPage();
+
+	if (page)
+	{
+		zeroPage((uint32_t) page);
+		poolStats.zeroedMisses++;
+	}
+
+	return page;
+}
+
+/*!
+ * \fn uint32_t poolRelease(uint32_t owner)
+ * \brief Return all the pages of an owner to the pool
+ * \param owner The owner, usually a torn down child partition
+ * \return The number of pages returned
+ * \note The pages must not be mapped anymore, which Pip_DeletePartition
+ *       ensures for the pages of a child partition.
+ */
+uint32_t poolRelease(uint32_t owner)
+{
+	struct pool_account *account = ACCOUNT(owner);
+	uint32_t released = 0;
+
+	for (uint32_t index = 0; index < memoryPages; index++)
+	{
+		if (OWNER(index) != owner)
+		{
+			continue;
+		}
+
+		uint32_t *page = (uint32_t*) (memoryBegin + index * PAGE_SIZE);
+
+		OWNER(index)  = POOL_FREE;
+		page[0]       = (uint32_t) dirtyPages;
+		dirtyPages    = page;
+		released++;
+	}
+
+	dirtyCount += released;
+	poolStats.recycled += released;
+
+	// The high-water marks of the owner are kept
+	for (uint32_t i = 0; i < POOL_CATEGORIES; i++)
+	{
+		totals.live[i]   -= account->live[i];
+		account->live[i]  = 0;
+	}
+
+	totals.liveTotal   -= account->liveTotal;
+	account->liveTotal  = 0;
+
+	return released;
+}
+
+/*!
+ * \fn void poolTransfer(uint32_t *page, uint32_t category, uint32_t owner)
+ * \brief Give an allocated page to another owner
+ * \param page The page
+ * \param category The pool_category the page was allocated in
+ * \param owner The new owner of the page
+ */
+void poolTransfer(uint32_t *page, uint32_t category, uint32_t owner)
+{
+	uint32_t index = ((uint32_t) page - memoryBegin) / PAGE_SIZE;
+
+	if (index >= memoryPages || OWNER(index) == owner)
+	{
+		return;
+	}
+
+	uncharge(ACCOUNT(OWNER(index)), category);
+	OWNER(index) = owner;
+
+	uint32_t previous = currentCategory;
+
+	currentCategory = category;
+	charge(ACCOUNT(owner));
+	currentCategory = previous;
+}
+
+/*!
+ * \fn void poolFree(uint32_t *page, uint32_t category)
+ * \brief Return a single page to the pool
+ * \param page The page, which must not be mapped in a child anymore
+ * \param category The pool_category the page was allocated in
+ * \note A page taken straight from Pip_AllocPage has no owner: it is adopted
+ *       by the pool without being uncharged.
+ */
+void poolFree(uint32_t *page, uint32_t category)
+{
+	uint32_t index = ((uint32_t) page - memoryBegin) / PAGE_SIZE;
+
+	if (index >= memoryPages)
+	{
+		return;
+	}
+
+	if (OWNER(index) != POOL_FREE)
+	{
+		uncharge(ACCOUNT(OWNER(index)), category);
+		uncharge(&totals, category);
+		OWNER(index) = POOL_FREE;
+	}
+
+	page[0]    = (uint32_t) dirtyPages;
+	dirtyPages = page;
+	dirtyCount++;
+	poolStats.recycled++;
+}
+
+/*!
+ * \fn uint32_t poolZeroIdle(void)
+ * \brief Zero a batch of pages into the stock while the root is idle
+ * \return The number of pages zeroed, 0 once the stock is full
+ * \note Recycled pages are zeroed first. Pages are only taken from
+ *       Pip_AllocPage until the stock reaches POOL_ZEROED_TARGET.
+ */
+uint32_t poolZeroIdle(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < POOL_ZERO_BATCH; i++)
+	{
+		uint32_t *page = dirtyPages;
+
+		if (page)
+		{
+			dirtyPages = (uint32_t*) page[0];
+			dirtyCount--;
+		}
+		else if (zeroedCount < POOL_ZEROED_TARGET)
+		{
+			page = Pip_AllocPage();
+
+			if (!page)
+			{
+				break;
+			}
+
+			poolStats.fromPip++;
+			setOwner(page, POOL_FREE);
+		}
+		else
+		{
+			break;
+		}
+
+		zeroPage((uint32_t) page);
+
+		page[0]     = (uint32_t) zeroedPages;
+		zeroedPages = page;
+		zeroedCount++;
+		poolStats.idleZeroed++;
+	}
+
+	return i;
+}
+
+/*!
+ * \fn const struct pool_account *poolAccount(uint32_t owner)
+ * \brief Get the pages held by an owner
+ * \param owner POOL_ROOT or POOL_OWNER(index) of a child partition
+ * \return The account of the owner
+ */
+const struct pool_account *poolAccount(uint32_t owner)
+{
+	return ACCOUNT(owner);
+}
+
+/*!
+ * \fn const struct pool_account *poolTotals(void)
+ * \brief Get the pages held by all the owners
+ * \return The account summing all the owners
+ */
+const struct pool_account *poolTotals(void)
+{
+	return &totals;
+}
+
+/*!
+ * \fn uint32_t poolFreePages(void)
+ * \brief Count the pages which can still be allocated
+ * \return The pages held by the pool and the pages left to Pip_AllocPage
+ * \note The pages Pip_AllocPage gave to the root partition outside of the
+ *       pool, such as the interrupt contexts, are not seen: the count is an
+ *       upper bound.
+ */
+uint32_t poolFreePages(void)
+{
+	uint32_t used = poolStats.fromPip + ownerTablePages +
+		ACCOUNT_TABLE_PAGES;
+
+	if (used > memoryPages)
+	{
+		return dirtyCount + zeroedCount + colorCount;
+	}
+
+	return memoryPages - used + dirtyCount + zeroedCount + colorCount;
+}
+
+/*!
+ * \fn void printPoolStats(void)
+ * \brief Print the counters of the pool to the serial link
+ */
+void printPoolStats(void)
+{
+	printf("Pool pages from Pip ... %d, recycled ... %d\n",
+			poolStats.fromPip, poolStats.recycled);
+	printf("Pool zeroed pages ... %d in stock, %d hits, %d misses, "
+			"%d zeroed while idle\n", zeroedCount,
+			poolStats.zeroedHits, poolStats.zeroedMisses,
+			poolStats.idleZeroed);
+
+	if (poolStats.colored)
+	{
+		printf("Pool colored pages ... %d, %d set aside, %d in stock\n",
+				poolStats.colored, poolStats.stashed,
+				colorCount);
+	}
+}
+
+/*!
+ * \fn void printPoolAccount(const struct pool_account *account)
+ * \brief Print an account to the serial link, ending the current line
+ * \param account The account
+ * \note Each category is printed as its live and peak page counts.
+ */
+void printPoolAccount(const struct pool_account *account)
+{
+	static const char *names[POOL_CATEGORIES] =
+	{
+		"other", "image", "stack", "vidt", "partition", "prepare",
+		"channel", "snapshot", "grant", "bench"
+	};
+
+	printf("%d live, %d peak (", account->liveTotal, account->peakTotal);
+
+	for (uint32_t i = 0; i < POOL_CATEGORIES; i++)
+	{
+		printf("%s%s %d/%d", i ? ", " : "", names[i],
+				account->live[i], account->peak[i]);
+	}
+
+	printf(")\n");
+}
@@ -0,0 +1,207 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the boot-phase profiler of the root partition
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+
+#include "cycles.h"
+#include "profile.h"
+
+/*!
+ * \struct profile_record
+ * \brief A timestamped event
+ */
+struct profile_record
+{
+	uint32_t event;		/*!< The event, see enum profile_event */
+	uint64_t cycles;	/*!< The time stamp counter at the event */
+};
+
+/*!
+ * \brief The names of the boot phases, as printed in the summary
+ */
+static const char *phaseNames[PROFILE_PHASES] =
+{
+	"boot", "paging", "interrupts", "bootstrap"
+};
+
+/*!
+ * \brief The profiler records
+ */
+static struct profile_record records[PROFILE_RECORDS];
+
+/*!
+ * \brief The number of records in use
+ */
+static uint32_t recordsCount;
+
+/*!
+ * \brief The number of events dropped because the records were full
+ */
+static uint32_t droppedCount;
+
+/*!
+ * \brief The number of page-map iterations, counted rather than recorded
+ */
+static uint32_t mapCount;
+
+/*!
+ * \brief The cycles of the shortest page-map iteration
+ */
+static uint32_t mapMin = 0xffffffff;
+
+/*!
+ * \brief The cycles of the longest page-map iteration
+ */
+static uint32_t mapMax;
+
+/*!
+ * \brief The cycles of all the page-map iterations
+ */
+static uint32_t mapTotal;
+
+/*!
+ * \brief The time stamp counter at the start of the open page-map
+ *        iteration, 0 if none is open
+ */
+static uint64_t mapStart;
+
+/*!
+ * \fn static void mapMark(enum profile_event event, uint64_t cycles)
+ * \brief Close the open page-map iteration, and open the next one on a
+ *        page-map event
+ * \param event PROFILE_MAP_PAGE or PROFILE_MAP_END
+ * \param cycles The time stamp counter at the event
+ */
+static void mapMark(enum profile_event event, uint64_t cycles)
+{
+	if (mapStart)
+	{
+		uint32_t iteration = (uint32_t) (cycles - mapStart);
+
+		mapCount++;
+		mapTotal += iteration;
+		mapMin    = iteration < mapMin ? iteration : mapMin;
+		mapMax    = iteration > mapMax ? iteration : mapMax;
+	}
+
+	mapStart = event == PROFILE_MAP_PAGE ? cycles : 0;
+}
+
+/*!
+ * \fn void profileMark(enum profile_event event)
+ * \brief Timestamp an event
+ * \param event The event to timestamp
+ * \note Only the phase events are recorded, so that the pages mapped for
+ *       large images and after the boot do not fill the records.
+ */
+void profileMark(enum profile_event event)
+{
+	if (event > PROFILE_READY)
+	{
+		mapMark(event, readCycles());
+		return;
+	}
+
+	if (recordsCount == PROFILE_RECORDS)
+	{
+		droppedCount++;
+		return;
+	}
+
+	records[recordsCount].event  = event;
+	records[recordsCount].cycles = readCycles();
+	recordsCount++;
+}
+
+/*!
+ * \fn void profileDump(const char *revision)
+ * \brief Print the profiler summary to the serial link
+ * \param revision The Pip revision the root partition is running on
+ * \note The summary is printed on a single line of space-separated
+ *       key=value pairs, the cycle counts being in hexadecimal:
+ *       PROFILE <phase>=<cycles> ... map.count=<n> map.min=<cycles>
+ *       map.max=<cycles> map.total=<cycles> dropped=<n> start=<tsc>
+ *       rev=<revision>
+ *       The start is the low word of the time stamp counter at the entry of
+ *       the root partition. The revision comes last as it may contain
+ *       spaces.
+ */
+void profileDump(const char *revision)
+{
+	uint32_t phaseCycles[PROFILE_PHASES] = { 0 };
+	int32_t  lastPhase = -1;
+	uint64_t lastPhaseCycles = 0;
+
+	for (uint32_t i = 0; i < recordsCount; i++)
+	{
+		struct profile_record *record = &records[i];
+
+		if (lastPhase >= 0 && lastPhase < PROFILE_PHASES)
+		{
+			phaseCycles[lastPhase] += (uint32_t)
+				(record->cycles - lastPhaseCycles);
+		}
+
+		lastPhase       = record->event;
+		lastPhaseCycles = record->cycles;
+	}
+
+	// A phase left open lasts until the summary
+	if (lastPhase >= 0 && lastPhase < PROFILE_PHASES)
+	{
+		phaseCycles[lastPhase] += (uint32_t)
+			(readCycles() - lastPhaseCycles);
+	}
+
+	printf("PROFILE");
+
+	for (uint32_t i = 0; i < PROFILE_PHASES; i++)
+	{
+		printf(" %s=%x", phaseNames[i], phaseCycles[i]);
+	}
+
+	printf(" map.count=%d map.min=%x map.max=%x map.total=%x dropped=%d",
+			mapCount, mapCount ? mapMin : 0, mapMax, mapTotal,
+			droppedCount);
+
+	printf(" start=%x", recordsCount ? (uint32_t) records[0].cycles : 0);
+
+	printf(" rev=%s\n", revision);
+}
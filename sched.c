@@ -0,0 +1,466 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the budgeted scheduler of the root partition, in the
+ * manner of an O(1) scheduler. The children with work are kept in the run
+ * queues of two arrays, a queue per priority and a bitmap of the non-empty
+ * queues in each array: the active array holds the children with ticks left
+ * in the current epoch, the expired array those which used up their budget.
+ * The elected child is the head of the highest non-empty queue of the active
+ * array, found with a single bit scan. Each timer tick charged to a child
+ * moves it to the tail of its queue, or to the expired array with its budget
+ * refilled once it is used up. The arrays are swapped when the active one is
+ * empty, which starts the next epoch.
+ *
+ * A child of higher priority thus always runs first, for at most its budget
+ * per epoch, and the lower priorities share the rest of the epoch. A child
+ * taking the timer interrupts itself keeps the processor on its ticks until
+ * its budget is used up or a child of higher priority may run. The
+ * cycles each child ran for are charged when an interrupt enters the root,
+ * and printed on keyboard interrupts with the switches to each child:
+ *
+ * SCHED <index> prio=<priority> budget=<ticks> cpu=<percent> ...
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+
+#include "cycles.h"
+#include "sched.h"
+
+/*!
+ * \brief The child partitions
+ */
+static struct partition *schedPartitions;
+
+/*!
+ * \brief The number of child partitions
+ */
+static uint32_t schedCount;
+
+/*!
+ * \brief The run queues of the current and of the next epoch
+ */
+static struct sched_array arrays[2];
+
+/*!
+ * \brief The run queues of the current epoch
+ */
+static struct sched_array *active = &arrays[0];
+
+/*!
+ * \brief The run queues of the next epoch
+ */
+static struct sched_array *expired = &arrays[1];
+
+/*!
+ * \brief The current epoch
+ */
+static uint32_t epoch;
+
+/*!
+ * \brief The number of children in the run queues
+ */
+static uint32_t runnable;
+
+/*!
+ * \brief The child running since the last election, SCHED_NONE if none
+ */
+static uint32_t running = SCHED_NONE;
+
+/*!
+ * \brief The time stamp counter at the last election
+ */
+static uint64_t runStart;
+
+/*!
+ * \brief The child the last interrupt entering the root interrupted
+ */
+static uint32_t interrupted = SCHED_NONE;
+
+/*!
+ * \brief The last child elected, for the switch counts
+ */
+static uint32_t last = SCHED_NONE;
+
+/*!
+ * \fn static uint32_t priorityOf(struct partition *partition)
+ * \brief Get the priority of a child
+ * \param partition The child partition
+ * \return The priority from its manifest, capped to the highest one
+ */
+static uint32_t priorityOf(struct partition *partition)
+{
+	uint32_t priority = partition->image->priority;
+
+	return priority < SCHED_PRIORITIES ? priority : SCHED_PRIORITIES - 1;
+}
+
+/*!
+ * \fn static uint32_t budgetOf(struct partition *partition)
+ * \brief Get the budget of a child
+ * \param partition The child partition
+ * \return The timer ticks per epoch from its manifest, or the default
+ */
+static uint32_t budgetOf(struct partition *partition)
+{
+	uint32_t budget = partition->image->budget;
+
+	return budget ? budget : SCHED_DEFAULT_BUDGET;
+}
+
+/*!
+ * \fn static struct sched_array *arrayOf(struct partition *partition)
+ * \brief Get the run queues of the epoch a child may run in
+ * \param partition The child partition
+ * \return The active or the expired array
+ */
+static struct sched_array *arrayOf(struct partition *partition)
+{
+	return partition->schedEpoch == epoch ? active : expired;
+}
+
+/*!
+ * \fn static void enqueue(uint32_t index)
+ * \brief Append a child to the run queue of its priority, in the array of
+ *        the epoch it may run in
+ * \param index The index of the child
+ */
+static void enqueue(uint32_t index)
+{
+	struct partition *partition = &schedPartitions[index];
+	struct sched_array *array   = arrayOf(partition);
+	uint32_t priority           = priorityOf(partition);
+	uint32_t tail               = array->tail[priority];
+
+	partition->schedPrev = tail;
+	partition->schedNext = SCHED_NONE;
+
+	if (tail == SCHED_NONE)
+	{
+		array->head[priority] = index;
+		array->bitmap |= 1U << priority;
+	}
+	else
+	{
+		schedPartitions[tail].schedNext = index;
+	}
+
+	array->tail[priority] = index;
+}
+
+/*!
+ * \fn static void dequeue(uint32_t index)
+ * \brief Remove a child from its run queue
+ * \param index The index of the child
+ */
+static void dequeue(uint32_t index)
+{
+	struct partition *partition = &schedPartitions[index];
+	struct sched_array *array   = arrayOf(partition);
+	uint32_t priority           = priorityOf(partition);
+
+	if (partition->schedPrev == SCHED_NONE)
+	{
+		array->head[priority] = partition->schedNext;
+	}
+	else
+	{
+		schedPartitions[partition->schedPrev].schedNext =
+			partition->schedNext;
+	}
+
+	if (partition->schedNext == SCHED_NONE)
+	{
+		array->tail[priority] = partition->schedPrev;
+	}
+	else
+	{
+		schedPartitions[partition->schedNext].schedPrev =
+			partition->schedPrev;
+	}
+
+	if (array->head[priority] == SCHED_NONE)
+	{
+		array->bitmap &= ~(1U << priority);
+	}
+}
+
+/*!
+ * \fn void schedInit(struct partition *partitions, uint32_t count)
+ * \brief Queue the bootstrapped children, with their whole budget
+ * \param partitions The child partitions
+ * \param count The number of child partitions
+ */
+void schedInit(struct partition *partitions, uint32_t count)
+{
+	schedPartitions = partitions;
+	schedCount      = count;
+
+	for (uint32_t i = 0; i < SCHED_PRIORITIES; i++)
+	{
+		arrays[0].head[i] = arrays[0].tail[i] = SCHED_NONE;
+		arrays[1].head[i] = arrays[1].tail[i] = SCHED_NONE;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		partitions[i].schedState = SCHED_QUEUED;
+		partitions[i].schedEpoch = epoch;
+		partitions[i].budgetLeft = budgetOf(&partitions[i]);
+
+		enqueue(i);
+	}
+
+	runnable = count;
+}
+
+/*!
+ * \fn uint32_t schedPick(void)
+ * \brief Elect the child to yield to, starting the next epoch when every
+ *        child with work used up its budget
+ * \return The index of the child, SCHED_NONE if no child has work
+ * \note The child is considered running from now on.
+ */
+uint32_t schedPick(void)
+{
+	if (!active->bitmap && expired->bitmap)
+	{
+		struct sched_array *array = active;
+
+		active  = expired;
+		expired = array;
+		epoch++;
+	}
+
+	running = SCHED_NONE;
+
+	if (active->bitmap)
+	{
+		running = active->head[31 - __builtin_clz(active->bitmap)];
+
+		if (running != last)
+		{
+			schedPartitions[running].switches++;
+			last = running;
+		}
+
+		runStart = readCycles();
+	}
+
+	return running;
+}
+
+/*!
+ * \fn void schedCharge(uint64_t entryCycles)
+ * \brief Charge the cycles the running child ran for, called when an
+ *        interrupt enters the root
+ * \param entryCycles The time stamp counter read by the entry stub
+ */
+void schedCharge(uint64_t entryCycles)
+{
+	interrupted = running;
+
+	if (running != SCHED_NONE)
+	{
+		schedPartitions[running].cpuCycles += entryCycles - runStart;
+		running = SCHED_NONE;
+	}
+}
+
+/*!
+ * \fn void schedTick(void)
+ * \brief Charge a timer tick to the child it interrupted, which goes to the
+ *        tail of its queue, or to the next epoch once its budget is used up
+ */
+void schedTick(void)
+{
+	if (interrupted == SCHED_NONE)
+	{
+		return;
+	}
+
+	struct partition *partition = &schedPartitions[interrupted];
+
+	partition->ticks++;
+
+	if (partition->schedState != SCHED_QUEUED)
+	{
+		return;
+	}
+
+	dequeue(interrupted);
+
+	if (--partition->budgetLeft == 0)
+	{
+		partition->budgetLeft = budgetOf(partition);
+		partition->schedEpoch = epoch + 1;
+	}
+
+	enqueue(interrupted);
+}
+
+/*!
+ * \fn uint32_t schedKeep(void)
+ * \brief Keep running the child a timer tick interrupted, for a child
+ *        taking the timer interrupts itself
+ * \return 1 if the child keeps the processor, 0 if it must be preempted as
+ *         the tick uses up its budget or a child of higher priority may run
+ *         in the current epoch
+ * \note The tick is left to schedTick, called once the child took it.
+ */
+uint32_t schedKeep(void)
+{
+	if (interrupted == SCHED_NONE)
+	{
+		return 0;
+	}
+
+	struct partition *partition = &schedPartitions[interrupted];
+
+	if (partition->schedState != SCHED_QUEUED ||
+	    partition->budgetLeft <= 1 ||
+	    active->bitmap >> (priorityOf(partition) + 1))
+	{
+		return 0;
+	}
+
+	// The child runs on from the tick, as if it had been elected again
+	running  = interrupted;
+	runStart = readCycles();
+
+	return 1;
+}
+
+/*!
+ * \fn void schedSleep(uint32_t index)
+ * \brief Take a child with no work left out of the run queues
+ * \param index The index of the child
+ */
+void schedSleep(uint32_t index)
+{
+	struct partition *partition = &schedPartitions[index];
+
+	if (partition->schedState == SCHED_QUEUED)
+	{
+		dequeue(index);
+		partition->schedState = SCHED_SLEEPING;
+		runnable--;
+	}
+}
+
+/*!
+ * \fn void schedWakeAll(void)
+ * \brief Queue the sleeping children again, in the epoch they may run in
+ * \note A child which used up its budget before sleeping does not run
+ *       before the next epoch.
+ */
+void schedWakeAll(void)
+{
+	for (uint32_t i = 0; i < schedCount; i++)
+	{
+		struct partition *partition = &schedPartitions[i];
+
+		if (partition->schedState != SCHED_SLEEPING)
+		{
+			continue;
+		}
+
+		// The epoch of the child may have ended while it slept
+		if (partition->schedEpoch != epoch &&
+		    partition->schedEpoch != epoch + 1)
+		{
+			partition->schedEpoch = epoch;
+			partition->budgetLeft = budgetOf(partition);
+		}
+
+		partition->schedState = SCHED_QUEUED;
+		enqueue(i);
+		runnable++;
+	}
+}
+
+/*!
+ * \fn uint32_t schedInterrupted(void)
+ * \brief Get the child the last interrupt entering the root interrupted
+ * \return The index of the child, SCHED_NONE if the root was idle
+ */
+uint32_t schedInterrupted(void)
+{
+	return interrupted;
+}
+
+/*!
+ * \fn uint32_t schedRunnable(void)
+ * \brief Count the children with work
+ * \return The number of children in the run queues
+ */
+uint32_t schedRunnable(void)
+{
+	return runnable;
+}
+
+/*!
+ * \fn void printSchedStats(void)
+ * \brief Print the priority, the budget, the share of the cycles run by the
+ *        children, the ticks and the switches of each child
+ */
+void printSchedStats(void)
+{
+	uint64_t total = 0;
+
+	for (uint32_t i = 0; i < schedCount; i++)
+	{
+		total += schedPartitions[i].cpuCycles;
+	}
+
+	for (uint32_t i = 0; i < schedCount; i++)
+	{
+		struct partition *partition = &schedPartitions[i];
+
+		printf("SCHED %d prio=%d budget=%d cpu=%d%% kcycles=%d "
+				"ticks=%d switches=%d left=%d%s\n", i,
+				priorityOf(partition), budgetOf(partition),
+				percentCycles(partition->cpuCycles, total),
+				averageCycles(partition->cpuCycles, 1000),
+				partition->ticks, partition->switches,
+				partition->budgetLeft,
+				partition->schedState == SCHED_SLEEPING ?
+				" sleeping" : "");
+	}
+
+	printf("SCHED epoch=%d runnable=%d\n", epoch, runnable);
+}
@@ -0,0 +1,751 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the driver of the host simulator: it lays out child
+ * images in a simulated memory, runs the launcher against the simulated
+ * libpip in a child process per run, and reports the outcome, the cycles and
+ * the Pip calls of each run.
+ *
+ * Usage: launcher-sim run [options]
+ *        launcher-sim bench
+ *        launcher-sim faults [options]
+ *
+ * Options:
+ *   -s <size>		the image size, with an optional K, M or G suffix
+ *   -n <count>		the number of children
+ *   -i			the children are instances of a single image
+ *   -m			the images are passed as boot modules
+ *   -u			the images are passed as unaligned boot modules
+ *   -c <count>		each child gets its own <count> cache colors
+ *   -f <call>:<n>[:<code>]	the nth call to <call> fails with <code>
+ *   -v			print the launcher output
+ */
+
+#define _GNU_SOURCE
+
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/personality.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <pip/fpinfo.h>
+#include <pip/paging.h>
+
+#include "sim.h"
+#include "launcher.h"
+#include "modules.h"
+#include "partitions.h"
+#include "pool.h"
+
+/*!
+ * \def SIM_MEMORY_VADDR
+ * \brief The host address of the simulated memory, below 4 GiB as the
+ *        launcher keeps addresses in 32-bit integers
+ */
+#define SIM_MEMORY_VADDR	0x10000000UL
+
+/*!
+ * \def SIM_MEMORY_MAX
+ * \brief The maximum size of the simulated memory
+ */
+#define SIM_MEMORY_MAX		0xc0000000UL
+
+/*!
+ * \def SIM_FREE_MEMORY
+ * \brief The free memory given to the launcher besides the image copies
+ */
+#define SIM_FREE_MEMORY		(64UL << 20)
+
+/*!
+ * \def SIM_TIMEOUT
+ * \brief The time limit of a run, in seconds
+ */
+#define SIM_TIMEOUT		60
+
+/*!
+ * \def SIM_SWEEP_MAX
+ * \brief The maximum number of failing calls tried per call and code
+ */
+#define SIM_SWEEP_MAX		48
+
+/*!
+ * \def SIM_UNALIGNED_OFFSET
+ * \brief The offset of the module directory from a page boundary when the
+ *        boot modules are unaligned
+ */
+#define SIM_UNALIGNED_OFFSET	64
+
+/*!
+ * \def SIM_LOAD_VADDR
+ * \brief The load address of the simulated child images
+ */
+#define SIM_LOAD_VADDR		0x700000
+
+/*!
+ * \enum sim_images
+ * \brief How the child images are passed to the launcher
+ */
+enum sim_images
+{
+	SIM_EMBEDDED,	/*!< In the child image table of the root */
+	SIM_MODULES,	/*!< As page-aligned boot modules */
+	SIM_UNALIGNED	/*!< As unaligned boot modules */
+};
+
+/*!
+ * \struct sim_config
+ * \brief The configuration of a run
+ */
+struct sim_config
+{
+	uint32_t size;		/*!< The image size, in bytes */
+	uint32_t children;	/*!< The number of children */
+	uint32_t instances;	/*!< Whether the children share their image */
+	struct sim_fault fault;	/*!< The fault injected */
+	uint32_t images;	/*!< How the images are passed, sim_images */
+	uint32_t colors;	/*!< The cache colors per child, 0 for any */
+};
+
+/*!
+ * \brief The child image table of the launcher, see partitions.S
+ */
+static struct child_image simImages[MAX_PARTITIONS + 1]
+	__attribute__((used));
+static uint32_t simImagesCount __attribute__((used));
+static char simNames[MAX_PARTITIONS + 1][16];
+
+__asm__(
+	".globl __childImages\n"
+	".set __childImages, simImages\n"
+	".globl __childImagesCount\n"
+	".set __childImagesCount, simImagesCount\n"
+	".globl __startReadOnlyAddress\n"
+	".set __startReadOnlyAddress, 0x700000\n"
+	".globl __endReadOnlyAddress\n"
+	".set __endReadOnlyAddress, 0x700000\n"
+	".globl __startChildAddress\n"
+	".set __startChildAddress, 0x700000\n"
+	".globl __endChildAddress\n"
+	".set __endChildAddress, 0x700000\n"
+);
+
+void _main(pip_fpinfo *bootInformations);
+
+/*!
+ * \fn static uint32_t childColors(struct sim_config *config, uint32_t index)
+ * \brief Get the cache colors of a child, each child getting its own
+ *        colors as long as there are enough of them
+ * \param config The run configuration
+ * \param index The index of the child
+ * \return The mask of the colors
+ */
+static uint32_t childColors(struct sim_config *config, uint32_t index)
+{
+	uint32_t first = (index * config->colors) % POOL_COLORS;
+	uint32_t colors = 0;
+
+	for (uint32_t i = 0; i < config->colors && i < POOL_COLORS; i++)
+	{
+		colors |= 1U << ((first + i) % POOL_COLORS);
+	}
+
+	return colors;
+}
+
+/*!
+ * \fn static uint32_t layoutModules(struct sim_config *config,
+ *		uint32_t base)
+ * \brief Lay out the child images as a boot module directory at the start
+ *        of the simulated memory, laid out as by layoutImages
+ * \param config The run configuration
+ * \param base The address of the simulated memory
+ * \return The address of the directory, the start of the free memory
+ */
+static uint32_t layoutModules(struct sim_config *config, uint32_t base)
+{
+	uint32_t address = base;
+
+	if (config->images == SIM_UNALIGNED)
+	{
+		address += SIM_UNALIGNED_OFFSET;
+	}
+
+	struct module_directory *directory =
+		(struct module_directory*) (uintptr_t) address;
+
+	uint32_t offset = (sizeof(struct module_directory) + config->children *
+			sizeof(struct module_entry) + PAGE_SIZE - 1) &
+		~(PAGE_SIZE - 1);
+
+	directory->magic = MODULES_MAGIC;
+	directory->count = config->children;
+
+	for (uint32_t i = 0; i < config->children; i++)
+	{
+		struct module_entry *entry = &directory->entries[i];
+
+		snprintf(entry->name, sizeof(entry->name), "sim%d", i);
+		entry->size        = config->size;
+		entry->loadAddress = SIM_LOAD_VADDR;
+		entry->flags       = 0;
+		entry->colors      = childColors(config, i);
+		entry->priority    = 0;
+		entry->budget      = 0;
+		entry->offset      = offset;
+
+		if (config->instances && i > 0)
+		{
+			entry->offset = directory->entries[0].offset;
+			continue;
+		}
+
+		struct image_layout *layout = (struct image_layout*)
+			(uintptr_t) (address + offset + config->size -
+			sizeof(struct image_layout));
+
+		layout->magic        = IMAGE_LAYOUT_MAGIC;
+		layout->readOnlySize = config->size - PAGE_SIZE;
+		layout->bssSize      = PAGE_SIZE;
+
+		offset += config->size;
+	}
+
+	directory->size = offset;
+	simImagesCount  = 0;
+
+	return address;
+}
+
+/*!
+ * \fn static void layoutImages(struct sim_config *config, uint32_t base)
+ * \brief Lay out the child images at the start of the simulated memory,
+ *        each ending with its layout footer: one data page, one bss page and
+ *        read-only pages for the rest
+ * \param config The run configuration
+ * \param base The address of the simulated memory
+ * \return The end of the images
+ */
+static uint32_t layoutImages(struct sim_config *config, uint32_t base)
+{
+	uint32_t address = base;
+
+	if (config->images != SIM_EMBEDDED)
+	{
+		return layoutModules(config, base);
+	}
+
+	simImagesCount = config->children;
+
+	for (uint32_t i = 0; i < config->children; i++)
+	{
+		struct child_image *image = &simImages[i];
+
+		snprintf(simNames[i], sizeof(simNames[i]), "sim%d", i);
+
+		if (!config->instances || i == 0)
+		{
+			image->start    = address;
+			image->end      = address + config->size;
+			image->imageEnd = image->end;
+			address         = image->end;
+
+			struct image_layout *layout = (struct image_layout*)
+				(uintptr_t) (image->imageEnd -
+				sizeof(struct image_layout));
+
+			layout->magic        = IMAGE_LAYOUT_MAGIC;
+			layout->readOnlySize = config->size - PAGE_SIZE;
+			layout->bssSize      = PAGE_SIZE;
+		}
+		else
+		{
+			*image = simImages[0];
+		}
+
+		image->name        = simNames[i];
+		image->loadAddress = SIM_LOAD_VADDR;
+		image->flags       = 0;
+		image->colors      = childColors(config, i);
+		image->priority    = 0;
+		image->budget      = 0;
+	}
+
+	return address;
+}
+
+/*!
+ * \fn static void simulate(struct sim_config *config)
+ * \brief Run the launcher in the current process, which never returns
+ * \param config The run configuration
+ */
+static void simulate(struct sim_config *config)
+{
+	uint64_t images = (uint64_t) config->size *
+		(config->instances ? 1 : config->children);
+	uint64_t copies = (uint64_t) config->size * config->children;
+	uint64_t size   = images + copies + SIM_FREE_MEMORY;
+
+	// The module directory takes at most a page and the unaligned images
+	// an extra one
+	if (config->images != SIM_EMBEDDED)
+	{
+		size += 2 * PAGE_SIZE;
+	}
+
+	if (size > SIM_MEMORY_MAX)
+	{
+		fprintf(stderr, "The simulated memory would exceed %lu MiB\n",
+				SIM_MEMORY_MAX >> 20);
+		_exit(1);
+	}
+
+	void *memory = mmap((void*) SIM_MEMORY_VADDR, size,
+			PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS |
+			MAP_NORESERVE | MAP_FIXED_NOREPLACE, -1, 0);
+
+	if (memory != (void*) SIM_MEMORY_VADDR)
+	{
+		perror("mmap");
+		_exit(1);
+	}
+
+	pip_fpinfo info = { FPINFO_MAGIC, 0, SIM_MEMORY_VADDR + size, 0, 0,
+		"simulator" };
+
+	info.membegin = layoutImages(config, SIM_MEMORY_VADDR);
+	simFault      = config->fault;
+
+	if (!simInitMemory(SIM_MEMORY_VADDR, info.memend))
+	{
+		_exit(1);
+	}
+
+	alarm(SIM_TIMEOUT);
+	_main(&info);
+
+	simPanic(__FILE__, __LINE__);
+}
+
+/*!
+ * \fn static void run(struct sim_config *config, struct sim_result *result)
+ * \brief Run the launcher in a child process
+ * \param config The run configuration
+ * \param result The result of the run
+ */
+static void run(struct sim_config *config, struct sim_result *result)
+{
+	memset(simResult, 0, sizeof(struct sim_result));
+	simResult->outcome = SIM_CRASH;
+	fflush(stdout);
+
+	pid_t pid = fork();
+
+	if (pid < 0)
+	{
+		perror("fork");
+		exit(1);
+	}
+
+	if (!pid)
+	{
+		simulate(config);
+	}
+
+	int status;
+
+	waitpid(pid, &status, 0);
+	*result = *simResult;
+
+	if (WIFSIGNALED(status))
+	{
+		result->outcome = WTERMSIG(status) == SIGALRM ? SIM_HANG :
+			SIM_CRASH;
+	}
+	else if (WEXITSTATUS(status))
+	{
+		fprintf(stderr, "The simulator could not run the launcher\n");
+		exit(1);
+	}
+}
+
+/*!
+ * \fn static uint32_t parseSize(const char *string)
+ * \brief Parse a size with an optional K, M or G suffix
+ */
+static uint32_t parseSize(const char *string)
+{
+	char *suffix;
+	uint64_t size = strtoull(string, &suffix, 0);
+
+	switch (*suffix)
+	{
+		case 'G': size <<= 10; /* fall through */
+		case 'M': size <<= 10; /* fall through */
+		case 'K': size <<= 10;
+	}
+
+	return (uint32_t) ((size + PAGE_SIZE - 1) & ~(uint64_t) (PAGE_SIZE - 1));
+}
+
+/*!
+ * \fn static uint32_t parseFault(const char *string, struct sim_fault *fault)
+ * \brief Parse a <call>:<n>[:<code>] fault
+ * \return 1 in the case of a success, 0 otherwise
+ */
+static uint32_t parseFault(const char *string, struct sim_fault *fault)
+{
+	const char *colon = strchr(string, ':');
+
+	if (!colon)
+	{
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < SIM_CALLS; i++)
+	{
+		if (strlen(simCallNames[i]) == (size_t) (colon - string) &&
+				!strncmp(simCallNames[i], string,
+				colon - string))
+		{
+			char *end;
+
+			fault->call = i;
+			fault->nth  = strtoul(colon + 1, &end, 0);
+			fault->code = *end == ':' ? strtoul(end + 1, 0, 0) : 0;
+
+			return fault->nth > 0;
+		}
+	}
+
+	return 0;
+}
+
+/*!
+ * \brief The names of the outcomes
+ */
+static const char *outcomeNames[SIM_OUTCOMES] =
+{
+	"ok", "panic", "crash", "hang"
+};
+
+/*!
+ * \fn static void printResult(struct sim_result *result)
+ * \brief Print the result of a run
+ */
+static void printResult(struct sim_result *result)
+{
+	printf("outcome ... %s %s\n", outcomeNames[result->outcome],
+			result->panic);
+	printf("cycles ... %llu\n", (unsigned long long) result->cycles);
+	printf("partitions ... %u, %u pages mapped, %u kernel pages, "
+			"%u pages allocated\n", result->partitions,
+			result->mappedPages, result->kernelPages,
+			result->allocatedPages);
+
+	for (uint32_t i = 0; i < SIM_CALLS; i++)
+	{
+		printf("%s ... %u\n", simCallNames[i], result->calls[i]);
+	}
+}
+
+/*!
+ * \fn static void bench(void)
+ * \brief Bootstrap a child of 1 MiB to 1 GiB, then up to MAX_PARTITIONS
+ *        children, distinct or instances of an image, and print the cycles
+ *        per mapped page, whose growth points at the hot spots
+ */
+static void bench(void)
+{
+	struct sim_config configs[32];
+	uint32_t count = 0;
+
+	for (uint32_t size = 1 << 20; size && size <= 1 << 30; size <<= 2)
+	{
+		configs[count++] = (struct sim_config)
+			{ size, 1, 0, { SIM_CALLS, 0, 0 } };
+	}
+
+	for (uint32_t instances = 0; instances < 2; instances++)
+	{
+		for (uint32_t n = 1; n <= MAX_PARTITIONS; n <<= 1)
+		{
+			configs[count++] = (struct sim_config)
+				{ 64 << 10, n, instances, { SIM_CALLS, 0, 0 } };
+		}
+	}
+
+	printf("%10s %8s %9s %14s %8s %12s %10s\n", "size", "children",
+			"instances", "cycles", "pages", "cycles/page",
+			"pip calls");
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		struct sim_result result;
+		uint32_t calls = 0;
+
+		run(&configs[i], &result);
+
+		for (uint32_t j = 0; j < SIM_CALLS; j++)
+		{
+			calls += result.calls[j];
+		}
+
+		printf("%9uK %8u %9s %14llu %8u %12llu %10u %s\n",
+				configs[i].size >> 10, configs[i].children,
+				configs[i].instances ? "yes" : "no",
+				(unsigned long long) result.cycles,
+				result.mappedPages,
+				(unsigned long long) result.cycles /
+				(result.mappedPages ? result.mappedPages : 1),
+				calls, result.outcome == SIM_OK ? "" :
+				outcomeNames[result.outcome]);
+	}
+}
+
+/*!
+ * \brief The codes a failing call returns in the fault sweep, the last one
+ *        being an unexpected code
+ */
+static const uint32_t wrapperCodes[] =
+{
+	FAIL_ALLOC_PAGE, FAIL_PREPARE, FAIL_ADD_VADDR, 0x42
+};
+static const uint32_t yieldCodes[] =
+{
+	1, 2, 3, 4, 5, 6, 7, 8, 9, 0x42
+};
+static const uint32_t nullCode[] = { 0 };
+
+/*!
+ * \fn static uint32_t faults(struct sim_config *config)
+ * \brief Make each call of the launcher fail in turn, with each code
+ *        main.c handles, and count the outcomes
+ * \param config The run configuration
+ * \return The number of crashes and hangs
+ */
+static uint32_t faults(struct sim_config *config)
+{
+	struct sim_result reference;
+	uint32_t failures = 0;
+
+	config->fault.call = SIM_CALLS;
+	run(config, &reference);
+
+	if (reference.outcome != SIM_OK)
+	{
+		printf("The reference run did not succeed: %s %s\n",
+				outcomeNames[reference.outcome],
+				reference.panic);
+		return 1;
+	}
+
+	for (uint32_t call = 0; call < SIM_CALLS; call++)
+	{
+		const uint32_t *codes = nullCode;
+		uint32_t codesCount   = 1;
+
+		if (call == SIM_MAP_PAGE_WRAPPER)
+		{
+			codes      = wrapperCodes;
+			codesCount = sizeof(wrapperCodes) / sizeof(uint32_t);
+		}
+		else if (call == SIM_YIELD)
+		{
+			codes      = yieldCodes;
+			codesCount = sizeof(yieldCodes) / sizeof(uint32_t);
+		}
+
+		for (uint32_t c = 0; c < codesCount; c++)
+		{
+			uint32_t outcomes[SIM_OUTCOMES] = { 0 };
+			uint32_t runs = reference.calls[call];
+
+			if (runs > SIM_SWEEP_MAX)
+			{
+				runs = SIM_SWEEP_MAX;
+			}
+
+			for (uint32_t nth = 1; nth <= runs; nth++)
+			{
+				struct sim_result result;
+
+				config->fault = (struct sim_fault)
+					{ call, nth, codes[c] };
+				run(config, &result);
+				outcomes[result.outcome]++;
+
+				if (result.outcome >= SIM_CRASH)
+				{
+					printf("%s:%u:%u ... %s\n",
+						simCallNames[call], nth,
+						codes[c],
+						outcomeNames[result.outcome]);
+				}
+			}
+
+			if (!runs)
+			{
+				continue;
+			}
+
+			printf("%-22s code 0x%-2x ... %2u runs: %u ok, %u panic, "
+					"%u crash, %u hang\n",
+					simCallNames[call], codes[c], runs,
+					outcomes[SIM_OK], outcomes[SIM_PANIC],
+					outcomes[SIM_CRASH], outcomes[SIM_HANG]);
+
+			failures += outcomes[SIM_CRASH] + outcomes[SIM_HANG];
+		}
+	}
+
+	return failures;
+}
+
+/*!
+ * \fn static void usage(const char *name)
+ * \brief Print the usage and exit
+ */
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s run|bench|faults [-s <size>] "
+			"[-n <count>] [-i] [-m|-u] [-c <count>] "
+			"[-f <call>:<n>[:<code>]] [-v]\n",
+			name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	struct sim_config config = { 64 << 10, 4, 0, { SIM_CALLS, 0, 0 } };
+	int option;
+
+	// The randomized heap may land in the simulated memory range: run the
+	// simulator again without address space randomization
+	int persona = personality(0xffffffff);
+
+	if (persona != -1 && !(persona & ADDR_NO_RANDOMIZE) &&
+			personality(persona | ADDR_NO_RANDOMIZE) != -1)
+	{
+		execv("/proc/self/exe", argv);
+	}
+
+	if (argc < 2)
+	{
+		usage(argv[0]);
+	}
+
+	optind = 2;
+
+	while ((option = getopt(argc, argv, "s:n:imuc:f:v")) != -1)
+	{
+		switch (option)
+		{
+			case 's':
+				config.size = parseSize(optarg);
+				break;
+			case 'n':
+				config.children = strtoul(optarg, 0, 0);
+				break;
+			case 'i':
+				config.instances = 1;
+				break;
+			case 'm':
+				config.images = SIM_MODULES;
+				break;
+			case 'u':
+				config.images = SIM_UNALIGNED;
+				break;
+			case 'c':
+				config.colors = strtoul(optarg, 0, 0);
+				break;
+			case 'f':
+				if (!parseFault(optarg, &config.fault))
+				{
+					usage(argv[0]);
+				}
+				break;
+			case 'v':
+				simVerbose = 1;
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+
+	if (config.size < 2 * PAGE_SIZE || !config.children ||
+			config.children > MAX_PARTITIONS + 1)
+	{
+		usage(argv[0]);
+	}
+
+	simResult = mmap(0, sizeof(struct sim_result), PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+	if (simResult == MAP_FAILED)
+	{
+		perror("mmap");
+		return 1;
+	}
+
+	if (!strcmp(argv[1], "run"))
+	{
+		struct sim_result result;
+
+		run(&config, &result);
+		printResult(&result);
+
+		return result.outcome >= SIM_CRASH;
+	}
+
+	if (!strcmp(argv[1], "bench"))
+	{
+		bench();
+		return 0;
+	}
+
+	if (!strcmp(argv[1], "faults"))
+	{
+		return faults(&config) != 0;
+	}
+
+	usage(argv[0]);
+
+	return 1;
+}
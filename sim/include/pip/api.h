@@ -0,0 +1,73 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the simulated libpip system calls
+ */
+
+#ifndef __DEF_PIP_API_H__
+#define __DEF_PIP_API_H__
+
+#include <stdint.h>
+
+#include <pip/arch_api.h>
+
+uint32_t Pip_CreatePartition(uint32_t descChild, uint32_t pdChild,
+		uint32_t shadow1Child, uint32_t shadow2Child,
+		uint32_t configPagesList);
+
+uint32_t Pip_DeletePartition(uint32_t descChild);
+
+uint32_t Pip_CountToMap(uint32_t descChild, uint32_t vaddr);
+
+uint32_t Pip_Prepare(uint32_t descChild, uint32_t vaddr, uint32_t page);
+
+uint32_t Pip_AddVAddr(uint32_t source, uint32_t descChild, uint32_t vaddr,
+		uint32_t read, uint32_t write, uint32_t execute);
+
+uint32_t Pip_RemoveVAddr(uint32_t descChild, uint32_t vaddr);
+
+uint32_t Pip_Collect(uint32_t descChild, uint32_t vaddr);
+
+uint32_t Pip_MappedInChild(uint32_t vaddr);
+
+uint32_t Pip_Yield(uint32_t descChild, uint32_t targetInterrupt,
+		uint32_t callerContextSaveIndex, uint32_t flagsOnYield,
+		uint32_t flagsOnWake);
+
+void Pip_Outb(uint32_t port, uint32_t value);
+
+uint32_t Pip_Inb(uint32_t port);
+
+#endif /* __DEF_PIP_API_H__ */
@@ -0,0 +1,64 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the simulated libpip boot information
+ */
+
+#ifndef __DEF_PIP_FPINFO_H__
+#define __DEF_PIP_FPINFO_H__
+
+#include <stdint.h>
+
+/*!
+ * \def FPINFO_MAGIC
+ * \brief The magic number of the boot information
+ */
+#define FPINFO_MAGIC	0xDEADCAFE
+
+/*!
+ * \struct pip_fpinfo
+ * \brief The boot information given to the root partition
+ */
+typedef struct pip_fpinfo
+{
+	uint32_t magic;		/*!< FPINFO_MAGIC */
+	uint32_t membegin;	/*!< The first free memory address */
+	uint32_t memend;	/*!< The end of the free memory */
+	uint32_t ssp;		/*!< The stack smashing protector value */
+	uint32_t nsmem;		/*!< Unused */
+	char revision[64];	/*!< The Pip revision */
+} pip_fpinfo;
+
+#endif /* __DEF_PIP_FPINFO_H__ */
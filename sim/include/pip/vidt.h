@@ -0,0 +1,66 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the simulated libpip interrupt declarations
+ */
+
+#ifndef __DEF_PIP_VIDT_H__
+#define __DEF_PIP_VIDT_H__
+
+#include <stdint.h>
+
+#include <pip/arch_api.h>
+
+/*!
+ * \def VIDT_VADDR
+ * \brief The address of the VIDT in a partition
+ */
+#define VIDT_VADDR	0xfffff000
+
+/*!
+ * \def VIDT
+ * \brief The VIDT of the root partition, an array of the simulator as the
+ *        host cannot map VIDT_VADDR
+ */
+#define VIDT	simVidt
+
+extern user_ctx_t *simVidt[256];
+
+user_ctx_t *Pip_AllocContext(void);
+
+void Pip_RegisterInterrupt(user_ctx_t *context, uint32_t vector,
+		uint32_t handler, uint32_t stack, uint32_t pipflags);
+
+#endif /* __DEF_PIP_VIDT_H__ */
@@ -0,0 +1,59 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the simulated libpip wrappers
+ */
+
+#ifndef __DEF_PIP_WRAPPERS_H__
+#define __DEF_PIP_WRAPPERS_H__
+
+#include <stdint.h>
+
+/*!
+ * \enum map_page_wrapper_ret_e
+ * \brief The return codes of Pip_MapPageWrapper
+ */
+enum map_page_wrapper_ret_e
+{
+	SUCCESS,		/*!< The page was mapped */
+	FAIL_ALLOC_PAGE,	/*!< A page could not be allocated */
+	FAIL_PREPARE,		/*!< Pip_Prepare failed */
+	FAIL_ADD_VADDR		/*!< Pip_AddVAddr failed */
+};
+
+enum map_page_wrapper_ret_e Pip_MapPageWrapper(uint32_t source,
+		uint32_t descChild, uint32_t vaddr);
+
+#endif /* __DEF_PIP_WRAPPERS_H__ */
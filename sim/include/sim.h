@@ -0,0 +1,135 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the declarations shared by the simulated libpip and
+ * the simulator driver. It is included first by every file of the
+ * simulator build, the launcher sources included.
+ */
+
+#ifndef __DEF_SIM_H__
+#define __DEF_SIM_H__
+
+#include <stdint.h>
+
+/*!
+ * \def PANIC()
+ * \brief End the simulated run as a panic of the launcher
+ */
+#define PANIC()	simPanic(__FILE__, __LINE__)
+
+/*!
+ * \def SIM_PREPARE_PAGES
+ * \brief The number of pages Pip_Prepare takes for a page table: the table
+ *        and its two shadows
+ */
+#define SIM_PREPARE_PAGES	3
+
+/*!
+ * \enum sim_call
+ * \brief The simulated libpip calls, counted and subject to fault injection
+ */
+enum sim_call
+{
+	SIM_INIT_PAGING,
+	SIM_ALLOC_PAGE,
+	SIM_ALLOC_CONTEXT,
+	SIM_REGISTER_INTERRUPT,
+	SIM_CREATE_PARTITION,
+	SIM_DELETE_PARTITION,
+	SIM_COUNT_TO_MAP,
+	SIM_PREPARE,
+	SIM_ADD_VADDR,
+	SIM_REMOVE_VADDR,
+	SIM_MAP_PAGE_WRAPPER,
+	SIM_YIELD,
+	SIM_CALLS
+};
+
+/*!
+ * \enum sim_outcome
+ * \brief The outcome of a simulated run
+ */
+enum sim_outcome
+{
+	SIM_OK,		/*!< The launcher yielded to its first child */
+	SIM_PANIC,	/*!< The launcher panicked */
+	SIM_CRASH,	/*!< The simulator process was killed by a signal */
+	SIM_HANG,	/*!< The run exceeded its time limit */
+	SIM_OUTCOMES
+};
+
+/*!
+ * \struct sim_fault
+ * \brief A fault injected into the simulated libpip: the nth call returns
+ *        the given code, 0 or a null pointer for most calls
+ */
+struct sim_fault
+{
+	uint32_t call;	/*!< The sim_call failing, SIM_CALLS for none */
+	uint32_t nth;	/*!< The failing call, counted from 1 */
+	uint32_t code;	/*!< The value returned by the failing call */
+};
+
+/*!
+ * \struct sim_result
+ * \brief The result of a simulated run, shared with the driver process
+ */
+struct sim_result
+{
+	uint32_t outcome;		/*!< The sim_outcome of the run */
+	uint64_t cycles;		/*!< Cycles from the entry to the end */
+	uint32_t calls[SIM_CALLS];	/*!< Calls to the simulated libpip */
+	uint32_t partitions;		/*!< Partitions alive at the end */
+	uint32_t mappedPages;		/*!< Pages mapped in the children */
+	uint32_t kernelPages;		/*!< Pages given to the kernel */
+	uint32_t allocatedPages;	/*!< Pages allocated by Pip_AllocPage */
+	char panic[96];			/*!< The location of the panic */
+};
+
+extern const char *simCallNames[SIM_CALLS];
+
+extern struct sim_fault simFault;
+
+extern struct sim_result *simResult;
+
+extern uint32_t simVerbose;
+
+uint32_t simInitMemory(uint32_t begin, uint32_t end);
+
+void simFinish(uint32_t outcome) __attribute__((noreturn));
+
+void simPanic(const char *file, int line) __attribute__((noreturn));
+
+#endif /* __DEF_SIM_H__ */
@@ -0,0 +1,742 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the simulated libpip. It keeps the bookkeeping of a
+ * Pip kernel on the host: the owner of every page of the simulated memory,
+ * the partitions and their page tables, so that the launcher is checked
+ * against the same rules as on Pip, a page being mapped into one child at
+ * most, and a page table taking SIM_PREPARE_PAGES prepared pages.
+ *
+ * Every call is counted, and the call selected by simFault fails with the
+ * given code.
+ */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <pip/api.h>
+#include <pip/paging.h>
+#include <pip/vidt.h>
+#include <pip/wrappers.h>
+
+#include "sim.h"
+#include "cycles.h"
+
+/*!
+ * \def SIM_ROOT
+ * \brief The owner of the pages of the root partition
+ */
+#define SIM_ROOT	0
+
+/*!
+ * \def SIM_KERNEL
+ * \brief The owner of the pages given to the kernel
+ */
+#define SIM_KERNEL	0xffffffff
+
+/*!
+ * \def SIM_TABLES
+ * \brief The number of page tables of a partition
+ */
+#define SIM_TABLES	1024
+
+/*!
+ * \def SIM_TABLE_INDEX(vaddr)
+ * \brief The page table covering an address
+ */
+#define SIM_TABLE_INDEX(vaddr)	((vaddr) >> 22)
+
+/*!
+ * \def SIM_PAGE_INDEX(vaddr)
+ * \brief The page table entry of an address
+ */
+#define SIM_PAGE_INDEX(vaddr)	(((vaddr) >> 12) & 0x3ff)
+
+/*!
+ * \struct sim_page
+ * \brief The state of a page of the simulated memory
+ */
+struct sim_page
+{
+	uint32_t owner;		/*!< SIM_ROOT, SIM_KERNEL or a descriptor */
+	uint32_t partition;	/*!< The partition described by the page,
+				     plus one, 0 if it is no descriptor */
+};
+
+/*!
+ * \struct sim_partition
+ * \brief A partition of the simulated kernel
+ */
+struct sim_partition
+{
+	uint32_t descriptor;		/*!< The descriptor, 0 if deleted */
+	uint32_t *tables[SIM_TABLES];	/*!< The page tables */
+	uint8_t prepared[SIM_TABLES];	/*!< The pages prepared per table */
+	uint32_t *kernelPages;		/*!< The pages given to the kernel */
+	uint32_t kernelCount;		/*!< The number of kernel pages */
+	uint32_t kernelSize;		/*!< The capacity of kernelPages */
+};
+
+const char *simCallNames[SIM_CALLS] =
+{
+	"Pip_InitPaging", "Pip_AllocPage", "Pip_AllocContext",
+	"Pip_RegisterInterrupt", "Pip_CreatePartition",
+	"Pip_DeletePartition", "Pip_CountToMap", "Pip_Prepare",
+	"Pip_AddVAddr", "Pip_RemoveVAddr", "Pip_MapPageWrapper", "Pip_Yield"
+};
+
+struct sim_fault simFault = { SIM_CALLS, 0, 0 };
+
+struct sim_result *simResult;
+
+uint32_t simVerbose;
+
+user_ctx_t *simVidt[256];
+
+/*!
+ * \brief The simulated memory and its pages
+ */
+static uint32_t memoryBegin, memoryPages;
+static struct sim_page *pages;
+
+/*!
+ * \brief The free memory given to Pip_InitPaging, allocated upwards
+ */
+static uint32_t allocNext, allocEnd;
+
+/*!
+ * \brief The pages given back by Pip_FreePage
+ */
+static uint32_t *freePages, freeCount;
+
+/*!
+ * \brief The page the contexts are allocated from
+ */
+static uint32_t contextPage, contextOffset;
+
+/*!
+ * \brief The partitions, deleted ones included
+ */
+static struct sim_partition *partitions;
+static uint32_t partitionsCount, partitionsSize;
+
+/*!
+ * \brief The time stamp of the start of the run
+ */
+static uint64_t startCycles;
+
+/*!
+ * \fn void irqStubs(void)
+ * \brief The interrupt entry stubs of the launcher, never run by the
+ *        simulator
+ */
+void irqStubs(void)
+{
+}
+
+/*!
+ * \fn int simPrintf(const char *format, ...)
+ * \brief Print the launcher output if the simulator runs verbosely
+ */
+int simPrintf(const char *format, ...)
+{
+	va_list args;
+	int ret = 0;
+
+	if (simVerbose)
+	{
+		va_start(args, format);
+		ret = vprintf(format, args);
+		va_end(args);
+	}
+
+	return ret;
+}
+
+/*!
+ * \fn static uint32_t inject(uint32_t call)
+ * \brief Count a call and tell whether it must fail
+ * \param call The sim_call
+ * \return 1 if the call must fail with simFault.code, 0 otherwise
+ */
+static uint32_t inject(uint32_t call)
+{
+	simResult->calls[call]++;
+
+	return simFault.call == call && simResult->calls[call] == simFault.nth;
+}
+
+/*!
+ * \fn static struct sim_page *page(uint32_t address)
+ * \brief Find the state of a page of the simulated memory
+ * \param address The page address
+ * \return The page state, 0 if the address is no page of the memory
+ */
+static struct sim_page *page(uint32_t address)
+{
+	uint32_t index = (address - memoryBegin) / PAGE_SIZE;
+
+	if (address & (PAGE_SIZE - 1) || address < memoryBegin ||
+			index >= memoryPages)
+	{
+		return 0;
+	}
+
+	return &pages[index];
+}
+
+/*!
+ * \fn static struct sim_partition *partition(uint32_t descriptor)
+ * \brief Find a partition from its descriptor
+ * \param descriptor The descriptor
+ * \return The partition, 0 if the descriptor is invalid
+ */
+static struct sim_partition *partition(uint32_t descriptor)
+{
+	struct sim_page *state = page(descriptor);
+
+	if (!state || !state->partition)
+	{
+		return 0;
+	}
+
+	return &partitions[state->partition - 1];
+}
+
+/*!
+ * \fn static uint32_t giveToKernel(struct sim_partition *part, uint32_t address)
+ * \brief Give a root page to the kernel on behalf of a partition
+ * \param part The partition
+ * \param address The page address
+ * \return 1 if the page was given, 0 if it is no free root page
+ */
+static uint32_t giveToKernel(struct sim_partition *part, uint32_t address)
+{
+	struct sim_page *state = page(address);
+
+	if (!state || state->owner != SIM_ROOT)
+	{
+		return 0;
+	}
+
+	if (part->kernelCount == part->kernelSize)
+	{
+		part->kernelSize  = part->kernelSize ? part->kernelSize * 2 : 8;
+		part->kernelPages = realloc(part->kernelPages,
+				part->kernelSize * sizeof(uint32_t));
+	}
+
+	part->kernelPages[part->kernelCount++] = address;
+	state->owner = SIM_KERNEL;
+	simResult->kernelPages++;
+
+	return 1;
+}
+
+/*!
+ * \fn uint32_t simInitMemory(uint32_t begin, uint32_t end)
+ * \brief Set the simulated memory, which belongs to the root partition
+ * \param begin The first page address
+ * \param end The end address
+ * \return 1 in the case of a success, 0 otherwise
+ */
+uint32_t simInitMemory(uint32_t begin, uint32_t end)
+{
+	memoryBegin = begin;
+	memoryPages = (end - begin) / PAGE_SIZE;
+	pages       = calloc(memoryPages, sizeof(struct sim_page));
+	startCycles = readCycles();
+
+	return pages != 0;
+}
+
+/*!
+ * \fn void simFinish(uint32_t outcome)
+ * \brief End the simulated run
+ * \param outcome The sim_outcome of the run
+ */
+void simFinish(uint32_t outcome)
+{
+	simResult->cycles  = readCycles() - startCycles;
+	simResult->outcome = outcome;
+
+	for (uint32_t i = 0; i < partitionsCount; i++)
+	{
+		if (partitions[i].descriptor)
+		{
+			simResult->partitions++;
+		}
+	}
+
+	fflush(stdout);
+	_exit(0);
+}
+
+/*!
+ * \fn void simPanic(const char *file, int line)
+ * \brief End the simulated run as a panic of the launcher
+ * \param file The source file of the panic
+ * \param line The source line of the panic
+ */
+void simPanic(const char *file, int line)
+{
+	snprintf(simResult->panic, sizeof(simResult->panic), "%s:%d",
+			file, line);
+
+	if (simVerbose)
+	{
+		printf("Panic at %s\n", simResult->panic);
+	}
+
+	simFinish(SIM_PANIC);
+}
+
+uint32_t Pip_InitPaging(uint32_t begin, uint32_t end)
+{
+	if (inject(SIM_INIT_PAGING))
+	{
+		return simFault.code;
+	}
+
+	if (!page(begin) || (end - memoryBegin) / PAGE_SIZE > memoryPages)
+	{
+		return 0;
+	}
+
+	allocNext = begin;
+	allocEnd  = end & ~(PAGE_SIZE - 1);
+
+	return 1;
+}
+
+/*!
+ * \fn static uint32_t *allocPage(void)
+ * \brief Allocate a root page, uncounted
+ * \return The page, 0 if the memory is exhausted
+ */
+static uint32_t *allocPage(void)
+{
+	uint32_t address;
+
+	if (freeCount)
+	{
+		address = freePages[--freeCount];
+	}
+	else if (allocNext < allocEnd)
+	{
+		address    = allocNext;
+		allocNext += PAGE_SIZE;
+	}
+	else
+	{
+		return 0;
+	}
+
+	simResult->allocatedPages++;
+
+	return (uint32_t*) (uintptr_t) address;
+}
+
+uint32_t *Pip_AllocPage(void)
+{
+	if (inject(SIM_ALLOC_PAGE))
+	{
+		return 0;
+	}
+
+	return allocPage();
+}
+
+void Pip_FreePage(uint32_t *address)
+{
+	struct sim_page *state = page((uint32_t) (uintptr_t) address);
+
+	if (!state || state->owner != SIM_ROOT)
+	{
+		return;
+	}
+
+	if (!(freeCount & (freeCount + 1)))
+	{
+		freePages = realloc(freePages,
+				(freeCount + 1) * 2 * sizeof(uint32_t));
+	}
+
+	freePages[freeCount++] = (uint32_t) (uintptr_t) address;
+}
+
+user_ctx_t *Pip_AllocContext(void)
+{
+	if (inject(SIM_ALLOC_CONTEXT))
+	{
+		return 0;
+	}
+
+	if (!contextPage || contextOffset + sizeof(user_ctx_t) > PAGE_SIZE)
+	{
+		contextPage   = (uint32_t) (uintptr_t) allocPage();
+		contextOffset = 0;
+
+		if (!contextPage)
+		{
+			return 0;
+		}
+	}
+
+	user_ctx_t *context = (user_ctx_t*) (uintptr_t)
+		(contextPage + contextOffset);
+	contextOffset += sizeof(user_ctx_t);
+
+	return context;
+}
+
+void Pip_RegisterInterrupt(user_ctx_t *context, uint32_t vector,
+		uint32_t handler, uint32_t stack, uint32_t pipflags)
+{
+	inject(SIM_REGISTER_INTERRUPT);
+}
+
+uint32_t Pip_CreatePartition(uint32_t descChild, uint32_t pdChild,
+		uint32_t shadow1Child, uint32_t shadow2Child,
+		uint32_t configPagesList)
+{
+	uint32_t args[5] = { descChild, pdChild, shadow1Child, shadow2Child,
+		configPagesList };
+
+	if (inject(SIM_CREATE_PARTITION))
+	{
+		return simFault.code;
+	}
+
+	for (uint32_t i = 0; i < 5; i++)
+	{
+		struct sim_page *state = page(args[i]);
+
+		if (!state || state->owner != SIM_ROOT)
+		{
+			return 0;
+		}
+
+		for (uint32_t j = 0; j < i; j++)
+		{
+			if (args[j] == args[i])
+			{
+				return 0;
+			}
+		}
+	}
+
+	if (partitionsCount == partitionsSize)
+	{
+		partitionsSize = partitionsSize ? partitionsSize * 2 : 64;
+		partitions     = realloc(partitions,
+				partitionsSize * sizeof(struct sim_partition));
+	}
+
+	struct sim_partition *part = &partitions[partitionsCount];
+
+	memset(part, 0, sizeof(struct sim_partition));
+	part->descriptor = descChild;
+
+	for (uint32_t i = 0; i < 5; i++)
+	{
+		giveToKernel(part, args[i]);
+	}
+
+	page(descChild)->partition = ++partitionsCount;
+
+	return 1;
+}
+
+uint32_t Pip_DeletePartition(uint32_t descChild)
+{
+	if (inject(SIM_DELETE_PARTITION))
+	{
+		return simFault.code;
+	}
+
+	struct sim_partition *part = partition(descChild);
+
+	if (!part)
+	{
+		return 0;
+	}
+
+	// Give the mapped pages and the kernel pages back to the root
+	for (uint32_t i = 0; i < SIM_TABLES; i++)
+	{
+		if (!part->tables[i])
+		{
+			continue;
+		}
+
+		for (uint32_t j = 0; j < 1024; j++)
+		{
+			if (part->tables[i][j])
+			{
+				page(part->tables[i][j])->owner = SIM_ROOT;
+				simResult->mappedPages--;
+			}
+		}
+
+		free(part->tables[i]);
+	}
+
+	for (uint32_t i = 0; i < part->kernelCount; i++)
+	{
+		page(part->kernelPages[i])->owner = SIM_ROOT;
+	}
+
+	simResult->kernelPages -= part->kernelCount;
+
+	free(part->kernelPages);
+	page(descChild)->partition = 0;
+	part->descriptor = 0;
+
+	return 1;
+}
+
+/*!
+ * \fn static uint32_t countToMap(uint32_t descChild, uint32_t vaddr)
+ * \brief Count the pages to prepare before mapping an address, uncounted
+ */
+static uint32_t countToMap(uint32_t descChild, uint32_t vaddr)
+{
+	struct sim_partition *part = partition(descChild);
+
+	if (!part)
+	{
+		return 0;
+	}
+
+	return SIM_PREPARE_PAGES - part->prepared[SIM_TABLE_INDEX(vaddr)];
+}
+
+uint32_t Pip_CountToMap(uint32_t descChild, uint32_t vaddr)
+{
+	if (inject(SIM_COUNT_TO_MAP))
+	{
+		return simFault.code;
+	}
+
+	return countToMap(descChild, vaddr);
+}
+
+/*!
+ * \fn static uint32_t prepare(uint32_t descChild, uint32_t vaddr,
+ *		uint32_t address)
+ * \brief Give a page to the kernel for a page table, uncounted
+ */
+static uint32_t prepare(uint32_t descChild, uint32_t vaddr, uint32_t address)
+{
+	struct sim_partition *part = partition(descChild);
+	uint32_t table = SIM_TABLE_INDEX(vaddr);
+
+	if (!part || part->prepared[table] == SIM_PREPARE_PAGES ||
+			!giveToKernel(part, address))
+	{
+		return 0;
+	}
+
+	if (++part->prepared[table] == SIM_PREPARE_PAGES)
+	{
+		part->tables[table] = calloc(1024, sizeof(uint32_t));
+	}
+
+	return 1;
+}
+
+uint32_t Pip_Prepare(uint32_t descChild, uint32_t vaddr, uint32_t address)
+{
+	if (inject(SIM_PREPARE))
+	{
+		return simFault.code;
+	}
+
+	return prepare(descChild, vaddr, address);
+}
+
+/*!
+ * \fn static uint32_t addVAddr(uint32_t source, uint32_t descChild,
+ *		uint32_t vaddr)
+ * \brief Map a root page into a child, uncounted
+ */
+static uint32_t addVAddr(uint32_t source, uint32_t descChild, uint32_t vaddr)
+{
+	struct sim_partition *part = partition(descChild);
+	struct sim_page *state     = page(source);
+
+	if (!part || !state || state->owner != SIM_ROOT ||
+			vaddr & (PAGE_SIZE - 1))
+	{
+		return 0;
+	}
+
+	uint32_t *table = part->tables[SIM_TABLE_INDEX(vaddr)];
+
+	if (!table || table[SIM_PAGE_INDEX(vaddr)])
+	{
+		return 0;
+	}
+
+	table[SIM_PAGE_INDEX(vaddr)] = source;
+	state->owner = descChild;
+	simResult->mappedPages++;
+
+	return 1;
+}
+
+uint32_t Pip_AddVAddr(uint32_t source, uint32_t descChild, uint32_t vaddr,
+		uint32_t read, uint32_t write, uint32_t execute)
+{
+	if (inject(SIM_ADD_VADDR))
+	{
+		return simFault.code;
+	}
+
+	return addVAddr(source, descChild, vaddr);
+}
+
+uint32_t Pip_RemoveVAddr(uint32_t descChild, uint32_t vaddr)
+{
+	if (inject(SIM_REMOVE_VADDR))
+	{
+		return simFault.code;
+	}
+
+	struct sim_partition *part = partition(descChild);
+
+	if (!part || !part->tables[SIM_TABLE_INDEX(vaddr)])
+	{
+		return 0;
+	}
+
+	uint32_t *entry = &part->tables[SIM_TABLE_INDEX(vaddr)]
+		[SIM_PAGE_INDEX(vaddr)];
+
+	if (!*entry)
+	{
+		return 0;
+	}
+
+	page(*entry)->owner = SIM_ROOT;
+	*entry = 0;
+	simResult->mappedPages--;
+
+	return 1;
+}
+
+uint32_t Pip_Collect(uint32_t descChild, uint32_t vaddr)
+{
+	return 0;
+}
+
+uint32_t Pip_MappedInChild(uint32_t vaddr)
+{
+	struct sim_page *state = page(vaddr);
+
+	if (!state || state->owner == SIM_ROOT || state->owner == SIM_KERNEL)
+	{
+		return 0;
+	}
+
+	return state->owner;
+}
+
+enum map_page_wrapper_ret_e Pip_MapPageWrapper(uint32_t source,
+		uint32_t descChild, uint32_t vaddr)
+{
+	if (inject(SIM_MAP_PAGE_WRAPPER))
+	{
+		return simFault.code;
+	}
+
+	uint32_t count = countToMap(descChild, vaddr);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t address = (uint32_t) (uintptr_t) allocPage();
+
+		if (!address)
+		{
+			return FAIL_ALLOC_PAGE;
+		}
+
+		if (!prepare(descChild, vaddr, address))
+		{
+			return FAIL_PREPARE;
+		}
+	}
+
+	if (!addVAddr(source, descChild, vaddr))
+	{
+		return FAIL_ADD_VADDR;
+	}
+
+	return SUCCESS;
+}
+
+uint32_t Pip_Yield(uint32_t descChild, uint32_t targetInterrupt,
+		uint32_t callerContextSaveIndex, uint32_t flagsOnYield,
+		uint32_t flagsOnWake)
+{
+	if (inject(SIM_YIELD))
+	{
+		return simFault.code;
+	}
+
+	// The launcher is done once it yields to a child
+	if (!partition(descChild))
+	{
+		snprintf(simResult->panic, sizeof(simResult->panic),
+				"Pip_Yield to an invalid child");
+		simFinish(SIM_PANIC);
+	}
+
+	simFinish(SIM_OK);
+}
+
+void Pip_Outb(uint32_t port, uint32_t value)
+{
+}
+
+uint32_t Pip_Inb(uint32_t port)
+{
+	return 0;
+}
@@ -0,0 +1,254 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the restart of misbehaving child partitions. The pages
+ * a child can write, its data, bss, stack, VIDT and channel pages, are
+ * recorded while it is bootstrapped and copied right after into pristine
+ * pages. A restart copies back the pages whose content changed and the
+ * initial context, keeping the partition descriptor, its page directory,
+ * its shadows and its read-only pages.
+ * \note Pip does not expose the dirty bits of the child page tables, the
+ *       dirty pages are found by comparing them with their pristine copy.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+#include <pip/paging.h>
+#include <pip/vidt.h>
+
+#include "cycles.h"
+#include "fpu.h"
+#include "pageops.h"
+#include "partitions.h"
+#include "pool.h"
+#include "snapshot.h"
+
+/*!
+ * \brief The snapshot of the child being bootstrapped, 0 if none
+ */
+static struct snapshot *recording;
+
+/*!
+ * \brief Whether the child being bootstrapped has too many writable pages
+ */
+static uint32_t overflowed;
+
+/*!
+ * \fn void snapshotBegin(struct partition *partition)
+ * \brief Start recording the writable pages of a child being bootstrapped
+ * \param partition The child partition
+ * \note The snapshot page is allocated to the current owner of the pool.
+ */
+void snapshotBegin(struct partition *partition)
+{
+	uint32_t category = poolSetCategory(POOL_SNAPSHOT);
+
+	partition->snapshot = 0;
+
+	recording  = (struct snapshot*) poolAllocZeroedPage();
+	overflowed = 0;
+
+	poolSetCategory(category);
+}
+
+/*!
+ * \fn void snapshotAdd(uint32_t page)
+ * \brief Record a page mapped writable into the child being bootstrapped
+ * \param page The address of the page
+ * \note Nothing is recorded when no child is being bootstrapped.
+ */
+void snapshotAdd(uint32_t page)
+{
+	if (!recording)
+	{
+		return;
+	}
+
+	if (recording->count == SNAPSHOT_MAX_PAGES)
+	{
+		overflowed = 1;
+		return;
+	}
+
+	recording->pages[recording->count++].page = page;
+}
+
+/*!
+ * \fn static void snapshotDrop(struct snapshot *snapshot, uint32_t copies)
+ * \brief Give a snapshot that cannot be used and its copies back to the pool
+ * \param snapshot The snapshot, 0 if its page could not be allocated
+ * \param copies The number of pages already copied
+ */
+static void snapshotDrop(struct snapshot *snapshot, uint32_t copies)
+{
+	if (!snapshot)
+	{
+		return;
+	}
+
+	for (uint32_t i = 0; i < copies; i++)
+	{
+		poolFree((uint32_t*) snapshot->pages[i].copy, POOL_SNAPSHOT);
+	}
+
+	poolFree((uint32_t*) snapshot, POOL_SNAPSHOT);
+}
+
+/*!
+ * \fn uint32_t snapshotEnd(struct partition *partition, uint32_t keep)
+ * \brief Stop recording the writable pages of a child and copy them
+ * \param partition The child partition
+ * \param keep 0 if the bootstrap failed and no snapshot must be taken
+ * \return 1 if the child can be restarted, 0 otherwise
+ * \note The copies are allocated to the current owner of the pool. When no
+ *       snapshot is taken, the pages copied so far are freed and the child
+ *       is left without snapshot, so that a restart aborts.
+ */
+uint32_t snapshotEnd(struct partition *partition, uint32_t keep)
+{
+	struct snapshot *snapshot = recording;
+
+	recording = 0;
+	partition->snapshot = 0;
+
+	if (!keep)
+	{
+		snapshotDrop(snapshot, 0);
+		return 0;
+	}
+
+	if (!snapshot || overflowed)
+	{
+		printf("No snapshot taken, the child cannot be restarted ...\n");
+		snapshotDrop(snapshot, 0);
+		return 0;
+	}
+
+	uint32_t category = poolSetCategory(POOL_SNAPSHOT);
+
+	for (uint32_t i = 0; i < snapshot->count; i++)
+	{
+		uint32_t copy = (uint32_t) poolAllocPage();
+
+		if (!copy)
+		{
+			printf("No page left for the snapshot, the child cannot "
+					"be restarted ...\n");
+			poolSetCategory(category);
+			snapshotDrop(snapshot, i);
+			return 0;
+		}
+
+		copyPage(copy, snapshot->pages[i].page);
+		snapshot->pages[i].copy = copy;
+	}
+
+	poolSetCategory(category);
+
+	snapshot->context   = *partition->context;
+	partition->snapshot = snapshot;
+
+	printf("Snapshot of %d writable pages taken\n", snapshot->count);
+
+	return 1;
+}
+
+/*!
+ * \fn uint32_t snapshotRestore(struct partition *partition)
+ * \brief Restart a child from its snapshot
+ * \param partition The child partition, which must have a snapshot
+ * \return The number of pages restored
+ * \note The channel pages are restored as the other writable pages: the
+ *       messages in flight and the buffered console output of the child
+ *       are dropped.
+ */
+uint32_t snapshotRestore(struct partition *partition)
+{
+	struct snapshot *snapshot = partition->snapshot;
+	uint32_t restored = 0;
+
+	uint64_t start = readCycles();
+
+	for (uint32_t i = 0; i < snapshot->count; i++)
+	{
+		struct snapshot_page *page = &snapshot->pages[i];
+
+		if (!samePage(page->page, page->copy))
+		{
+			copyPage(page->page, page->copy);
+			restored++;
+		}
+	}
+
+	*partition->context = snapshot->context;
+	partition->consoleWork = 0;
+
+	if (partition->fpuArea)
+	{
+		fpuForget(partition);
+		fpuInitArea(partition->fpuArea);
+	}
+
+	snapshot->restarts++;
+	snapshot->restoredPages += restored;
+	snapshot->restartCycles += readCycles() - start;
+
+	return restored;
+}
+
+/*!
+ * \fn void printSnapshotStats(const struct partition *partition,
+ *		uint32_t index)
+ * \brief Print the restart counters of a child, if it was restarted
+ * \param partition The child partition
+ * \param index The index of the child
+ */
+void printSnapshotStats(const struct partition *partition, uint32_t index)
+{
+	const struct snapshot *snapshot = partition->snapshot;
+
+	if (!snapshot || !snapshot->restarts)
+	{
+		return;
+	}
+
+	printf("Child %d restarts ... %d\n", index, snapshot->restarts);
+	printf("Child %d restored pages per restart ... %d\n", index,
+			snapshot->restoredPages / snapshot->restarts);
+	printf("Child %d cycles per restart ... %d\n", index,
+			averageCycles(snapshot->restartCycles,
+				snapshot->restarts));
+}
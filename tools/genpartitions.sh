@@ -0,0 +1,195 @@
+###############################################################################
+#  © Université de Lille, The Pip Development Team (2015-2024)                #
+#                                                                             #
+#  This software is a computer program whose purpose is to run a minimal,     #
+#  hypervisor relying on proven properties such as memory isolation.          #
+#                                                                             #
+#  This software is governed by the CeCILL license under French law and       #
+#  abiding by the rules of distribution of free software.  You can  use,      #
+#  modify and/ or redistribute the software under the terms of the CeCILL     #
+#  license as circulated by CEA, CNRS and INRIA at the following URL          #
+#  "http://www.cecill.info".                                                  #
+#                                                                             #
+#  As a counterpart to the access to the source code and  rights to copy,     #
+#  modify and redistribute granted by the license, users are provided only    #
+#  with a limited warranty  and the software's author,  the holder of the     #
+#  economic rights,  and the successive licensors  have only  limited         #
+#  liability.                                                                 #
+#                                                                             #
+#  In this respect, the user's attention is drawn to the risks associated     #
+#  with loading,  using,  modifying and/or developing or reproducing the      #
+#  software by the user in light of its specific status of free software,     #
+#  that may mean  that it is complicated to manipulate,  and  that  also      #
+#  therefore means  that it is reserved for developers  and  experienced      #
+#  professionals having in-depth computer knowledge. Users are therefore      #
+#  encouraged to load and test the software's suitability as regards their    #
+#  requirements in conditions enabling the security of their systems and/or   #
+#  data to be ensured and,  more generally, to use and operate it in the      #
+#  same conditions as regards security.                                       #
+#                                                                             #
+#  The fact that you are presently reading this means that you have had       #
+#  knowledge of the CeCILL license and that you accept its terms.             #
+###############################################################################
+
+# Generate the child partition images and table from the partition manifest
+#
+# Usage: genpartitions.sh <manifest> <assembly output> <linker script output>
+#
+# The options column of the manifest is turned into the CHILD_* flags of
+# partitions.h, which must be kept in sync with the options table below. The
+# colors=<first>[-<last>] option gives the cache colors of the child pages,
+# the prio=<0-7> option its scheduling priority, 0 the lowest, and the
+# budget=<ticks> option its timer ticks per scheduling epoch. The colors are
+# checked against the POOL_COLORS environment variable, 32 by default, which
+# the Makefile shares with include/pool.h.
+#
+# The assembly output embeds each distinct image once, in its own .image<N>
+# section, and defines the __childImages table read by the root partition:
+# several children listed with the same image are instances of it. The
+# linker script output is included by link.ld in order to place the
+# sections and to define the __startImage<N>, __imageEnd<N> and
+# __endImage<N> symbols.
+
+set -e
+
+if [ $# -ne 3 ]; then
+	echo "usage: $0 <manifest> <assembly output> <linker script output>" >&2
+	exit 1
+fi
+
+awk -v asmout="$2" -v ldout="$3" -v poolColors="${POOL_COLORS:-32}" '
+function header(out)
+{
+	print "/* Generated from " FILENAME " by tools/genpartitions.sh */" > out
+	print "" > out
+}
+
+BEGIN {
+	count = 0
+	failed = 0
+	imagesCount = 0
+
+	options["lazy"] = 1
+	options["lz4"]  = 2
+	options["timer"] = 4
+	options["fpu"]   = 8
+}
+
+/^[ \t]*(#|$)/ { next }
+
+NF != 3 && NF != 4 {
+	printf "%s:%d: expected <name> <image> <load address> [options]\n",
+		FILENAME, FNR > "/dev/stderr"
+	failed = 1
+	exit 1
+}
+
+{
+	image = $2
+
+	# Compressed images are built from the image by tools/lz4pack
+	if (NF == 4 && $4 ~ /(^|,)lz4(,|$)/) {
+		image = image ".lz4"
+	}
+
+	if (!(image in imageIndex)) {
+		imageIndex[image] = imagesCount
+		images[imagesCount++] = image
+	}
+
+	names[count]    = $1
+	children[count] = imageIndex[image]
+	loads[count]    = $3
+	flags[count]    = 0
+	colors[count]   = 0
+	prios[count]    = 0
+	budgets[count]  = 0
+
+	if (NF == 4) {
+		n = split($4, opts, ",")
+		for (j = 1; j <= n; j++) {
+			# The cache colors are given as a range of colors
+			if (opts[j] ~ /^colors=[0-9]+(-[0-9]+)?$/) {
+				split(substr(opts[j], 8), range, "-")
+				first = range[1] + 0
+				last  = (2 in range) ? range[2] + 0 : first
+				delete range
+				if (first > last || last >= poolColors) {
+					printf "%s:%d: invalid color range %s\n",
+						FILENAME, FNR, opts[j] > "/dev/stderr"
+					failed = 1
+					exit 1
+				}
+				for (c = first; c <= last; c++) {
+					colors[count] += 2 ^ c
+				}
+				continue
+			}
+			if (opts[j] ~ /^prio=[0-7]$/) {
+				prios[count] = substr(opts[j], 6)
+				continue
+			}
+			if (opts[j] ~ /^budget=[0-9]+$/) {
+				budgets[count] = substr(opts[j], 8)
+				continue
+			}
+			if (!(opts[j] in options)) {
+				printf "%s:%d: unknown option %s\n",
+					FILENAME, FNR, opts[j] > "/dev/stderr"
+				failed = 1
+				exit 1
+			}
+			flags[count] += options[opts[j]]
+		}
+	}
+
+	count++
+}
+
+END {
+	if (failed) {
+		exit 1
+	}
+
+	# The children may all be passed as boot modules, see tools/modpack.c
+	if (count == 0) {
+		printf "%s: no child partition embedded\n", FILENAME > "/dev/stderr"
+	}
+
+	header(asmout)
+	header(ldout)
+
+	for (i = 0; i < imagesCount; i++) {
+		printf ".section .image%d, \"a\"\n", i > asmout
+		printf ".incbin \"%s\"\n\n", images[i] > asmout
+
+		printf "\t. = ALIGN(4K);\n" > ldout
+		printf "\t__startImage%d = . ;\n", i > ldout
+		printf "\tKEEP(*(.image%d))\n", i > ldout
+		printf "\t__imageEnd%d = . ;\n", i > ldout
+		printf "\t. = ALIGN(4K);\n" > ldout
+		printf "\t__endImage%d = . ;\n", i > ldout
+	}
+
+	print ".section .rodata" > asmout
+	for (i = 0; i < count; i++) {
+		printf "childName%d:\n\t.asciz \"%s\"\n", i, names[i] > asmout
+	}
+
+	print "" > asmout
+	print ".section .data" > asmout
+	print ".balign 4" > asmout
+	print ".global __childImagesCount" > asmout
+	print "__childImagesCount:" > asmout
+	printf "\t.long %d\n\n", count > asmout
+	print ".global __childImages" > asmout
+	print "__childImages:" > asmout
+	for (i = 0; i < count; i++) {
+		n = children[i]
+		printf "\t.long childName%d, __startImage%d, __endImage%d, " \
+			"__imageEnd%d, %s, %d, %.0f, %d, %d\n", i, n, n, n,
+			loads[i], flags[i], colors[i], prios[i],
+			budgets[i] > asmout
+	}
+}
+' "$1"
@@ -0,0 +1,239 @@
+###############################################################################
+#  © Université de Lille, The Pip Development Team (2015-2024)                #
+#                                                                             #
+#  This software is a computer program whose purpose is to run a minimal,     #
+#  hypervisor relying on proven properties such as memory isolation.          #
+#                                                                             #
+#  This software is governed by the CeCILL license under French law and       #
+#  abiding by the rules of distribution of free software.  You can  use,      #
+#  modify and/ or redistribute the software under the terms of the CeCILL     #
+#  license as circulated by CEA, CNRS and INRIA at the following URL          #
+#  "http://www.cecill.info".                                                  #
+#                                                                             #
+#  As a counterpart to the access to the source code and  rights to copy,     #
+#  modify and redistribute granted by the license, users are provided only    #
+#  with a limited warranty  and the software's author,  the holder of the     #
+#  economic rights,  and the successive licensors  have only  limited         #
+#  liability.                                                                 #
+#                                                                             #
+#  In this respect, the user's attention is drawn to the risks associated     #
+#  with loading,  using,  modifying and/or developing or reproducing the      #
+#  software by the user in light of its specific status of free software,     #
+#  that may mean  that it is complicated to manipulate,  and  that  also      #
+#  therefore means  that it is reserved for developers  and  experienced      #
+#  professionals having in-depth computer knowledge. Users are therefore      #
+#  encouraged to load and test the software's suitability as regards their    #
+#  requirements in conditions enabling the security of their systems and/or   #
+#  data to be ensured and,  more generally, to use and operate it in the      #
+#  same conditions as regards security.                                       #
+#                                                                             #
+#  The fact that you are presently reading this means that you have had       #
+#  knowledge of the CeCILL license and that you accept its terms.             #
+###############################################################################
+
+# Build the launcher variants and check them for boot time and size
+# regressions
+#
+# Usage: harness.sh [--baseline]
+#
+# Each variant is built from a clean tree with the OPT and GC variables of
+# the Makefiles, which apply to both the root partition and the children.
+# The following metrics are recorded into harness/results, one
+# "<variant> <metric> <value>" line each:
+#
+#   root.size		the size of the root partition image
+#   root.span		__endReadOnlyAddress - __startReadOnlyAddress
+#   child.size.<name>	the size of each child image of the manifest
+#   boot.cycles		the cycles from the entry of the root partition to the
+#			first output of a child, "start" of the PROFILE line
+#			to the first "FIRST tsc" line
+#
+# The boot time needs a Pip kernel image embedding the root partition: the
+# PIP_BUILD command, run after each build with ROOT_BIN set to the root
+# partition image, must produce the PIP_KERNEL image, which is booted under
+# QEMU TCG with its serial output captured into harness/<variant>.serial.
+# The boot time is skipped when PIP_KERNEL is not set.
+#
+# The results are compared with tools/harness.baseline, and the harness fails
+# when a metric exceeds its baseline by more than the percentage given in
+# tools/harness.thresholds, "<metric> <percent>" lines in which a metric
+# ending with a dot stands for every metric it prefixes. With --baseline,
+# the results replace the baseline instead.
+
+set -u
+
+cd "$(dirname "$0")/.."
+
+VARIANTS=${VARIANTS:-"O0 O2 Os O0-gc O2-gc Os-gc"}
+QEMU=${QEMU:-qemu-system-i386}
+PIP_KERNEL=${PIP_KERNEL:-}
+PIP_BUILD=${PIP_BUILD:-}
+BOOT_TIMEOUT=${BOOT_TIMEOUT:-30}
+
+OUT=harness
+RESULTS=$OUT/results
+BASELINE=tools/harness.baseline
+THRESHOLDS=tools/harness.thresholds
+NAME=$(basename "$(pwd)")
+
+# Print the value of a symbol of the root partition link map
+symbol()
+{
+	awk -v name="$1" '$2 == name { print $1; exit }' "$NAME.map"
+}
+
+# Print the difference of two hexadecimal numbers modulo 2^32
+hexdiff()
+{
+	awk -v a="$1" -v b="$2" '
+	function hex(s,    i, v)
+	{
+		sub(/^0x/, "", s)
+		v = 0
+		for (i = 1; i <= length(s); i++)
+			v = v * 16 + index("0123456789abcdef",
+					tolower(substr(s, i, 1))) - 1
+		return v
+	}
+	BEGIN {
+		d = hex(a) - hex(b)
+		if (d < 0)
+			d += 4294967296
+		printf "%d\n", d % 4294967296
+	}'
+}
+
+# Boot the Pip kernel image under QEMU until a child printed its first line
+boot()
+{
+	serial=$OUT/$1.serial
+	rm -f "$serial"
+
+	"$QEMU" -kernel "$PIP_KERNEL" -display none -monitor none \
+		-serial "file:$serial" -icount shift=0 -no-reboot &
+	pid=$!
+
+	elapsed=0
+	while [ $elapsed -lt "$BOOT_TIMEOUT" ]; do
+		grep -q "^FIRST tsc=" "$serial" 2>/dev/null && break
+		sleep 1
+		elapsed=$((elapsed + 1))
+	done
+
+	kill $pid 2>/dev/null
+	wait $pid 2>/dev/null
+
+	start=$(sed -n 's/^PROFILE.* start=\([0-9a-f]*\).*/\1/p' "$serial" |
+		head -n 1)
+	first=$(sed -n 's/^FIRST tsc=\([0-9a-f]*\).*/\1/p' "$serial" |
+		head -n 1)
+
+	if [ -z "$start" ] || [ -z "$first" ]; then
+		echo "$1: no boot markers in $serial" >&2
+		return 1
+	fi
+
+	echo "$1 boot.cycles $(hexdiff "$first" "$start")" >> "$RESULTS"
+}
+
+mkdir -p $OUT
+: > "$RESULTS"
+failed=0
+
+for variant in $VARIANTS; do
+	case $variant in
+		*-gc) gc=1 ;;
+		*)    gc=0 ;;
+	esac
+	opt=-${variant%-gc}
+
+	echo "Building the $variant variant ..."
+	make clean > /dev/null
+	if ! make OPT="$opt" GC=$gc > "$OUT/$variant.build" 2>&1; then
+		echo "$variant: build failed, see $OUT/$variant.build" >&2
+		failed=1
+		continue
+	fi
+
+	echo "$variant root.size $(wc -c < "$NAME.bin")" >> "$RESULTS"
+	echo "$variant root.span $(hexdiff "$(symbol __endReadOnlyAddress)" \
+		"$(symbol __startReadOnlyAddress)")" >> "$RESULTS"
+
+	awk '!/^[ \t]*(#|$)/ { print $1, $2 }' partitions.conf |
+	while read -r child image; do
+		echo "$variant child.size.$child $(wc -c < "$image")"
+	done >> "$RESULTS"
+
+	if [ -z "$PIP_KERNEL" ]; then
+		continue
+	fi
+
+	if [ -n "$PIP_BUILD" ] && ! ROOT_BIN="$(pwd)/$NAME.bin" \
+			sh -c "$PIP_BUILD" > "$OUT/$variant.pip" 2>&1; then
+		echo "$variant: PIP_BUILD failed, see $OUT/$variant.pip" >&2
+		failed=1
+		continue
+	fi
+
+	boot "$variant" || failed=1
+done
+
+make clean > /dev/null
+
+if [ -z "$PIP_KERNEL" ]; then
+	echo "PIP_KERNEL is not set, the boot time was not measured"
+fi
+
+if [ $# -ge 1 ] && [ "$1" = "--baseline" ]; then
+	cp "$RESULTS" "$BASELINE"
+	echo "Baseline written to $BASELINE"
+	exit $failed
+fi
+
+if [ ! -f "$BASELINE" ]; then
+	echo "No baseline in $BASELINE, run make harness-baseline"
+	exit $failed
+fi
+
+awk -v thresholds="$THRESHOLDS" -v baseline="$BASELINE" '
+function threshold(metric,    key)
+{
+	if (metric in limits)
+		return limits[metric]
+	for (key in limits)
+		if (key ~ /\.$/ && index(metric, key) == 1)
+			return limits[key]
+	return -1
+}
+BEGIN {
+	while ((getline line < thresholds) > 0) {
+		if (line ~ /^[ \t]*(#|$)/)
+			continue
+		split(line, f)
+		limits[f[1]] = f[2]
+	}
+	while ((getline line < baseline) > 0) {
+		split(line, f)
+		base[f[1] " " f[2]] = f[3]
+	}
+	status = 0
+}
+{
+	key = $1 " " $2
+	limit = threshold($2)
+	if (!(key in base) || limit < 0) {
+		printf "%-8s %-24s %10d\n", $1, $2, $3
+		next
+	}
+	verdict = "ok"
+	if ($3 * 100 > base[key] * (100 + limit)) {
+		verdict = "REGRESSION"
+		status = 1
+	}
+	printf "%-8s %-24s %10d %10d %s\n", $1, $2, $3, base[key], verdict
+}
+END {
+	exit status
+}' "$RESULTS" || failed=1
+
+exit $failed
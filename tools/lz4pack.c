@@ -0,0 +1,256 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * Host tool compressing a flat child image for the root partition
+ *
+ * Usage: lz4pack <image> <output>
+ *
+ * Each page of the image is compressed as an independent LZ4 block, so that
+ * the root partition can decompress the image page by page, straight into
+ * the pages it maps into the child. The output format must be kept in sync
+ * with struct lz4_image_header in include/lz4.h.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PAGE_SIZE	0x1000
+#define LZ4_IMAGE_MAGIC	0x345a4c50
+#define LZ4_BLOCK_RAW	0x80000000
+#define LAYOUT_SIZE	12
+#define MIN_MATCH	4
+#define HASH_BITS	12
+
+static uint32_t read32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static uint8_t *putLength(uint8_t *out, size_t length)
+{
+	for (; length >= 255; length -= 255)
+	{
+		*out++ = 255;
+	}
+
+	*out++ = (uint8_t) length;
+
+	return out;
+}
+
+static uint8_t *putSequence(uint8_t *out, const uint8_t *literals,
+		size_t literalsLength, size_t offset, size_t matchLength)
+{
+	uint8_t *token = out++;
+
+	*token = (literalsLength < 15 ? literalsLength : 15) << 4;
+
+	if (literalsLength >= 15)
+	{
+		out = putLength(out, literalsLength - 15);
+	}
+
+	memcpy(out, literals, literalsLength);
+	out += literalsLength;
+
+	// The last sequence only holds literals
+	if (!matchLength)
+	{
+		return out;
+	}
+
+	*out++ = offset & 0xff;
+	*out++ = offset >> 8;
+
+	matchLength -= MIN_MATCH;
+	*token |= matchLength < 15 ? matchLength : 15;
+
+	if (matchLength >= 15)
+	{
+		out = putLength(out, matchLength - 15);
+	}
+
+	return out;
+}
+
+/*
+ * Greedy LZ4 block compression. The block format requires the last five
+ * bytes to be literals and the last match to start twelve bytes before the
+ * end of the block at the latest.
+ */
+static size_t compressBlock(const uint8_t *in, size_t size, uint8_t *out)
+{
+	int32_t table[1 << HASH_BITS];
+	uint8_t *start = out;
+	size_t anchor = 0, ip = 0;
+	size_t matchStartLimit = size > 12 ? size - 12 : 0;
+	size_t matchEndLimit   = size > 5 ? size - 5 : 0;
+
+	memset(table, 0xff, sizeof(table));
+
+	while (ip < matchStartLimit)
+	{
+		uint32_t sequence = read32(in + ip);
+		uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+		int32_t reference = table[hash];
+
+		table[hash] = (int32_t) ip;
+
+		if (reference < 0 || read32(in + reference) != sequence)
+		{
+			ip++;
+			continue;
+		}
+
+		size_t length = MIN_MATCH;
+
+		while (ip + length < matchEndLimit &&
+				in[reference + length] == in[ip + length])
+		{
+			length++;
+		}
+
+		out = putSequence(out, in + anchor, ip - anchor,
+				ip - reference, length);
+
+		ip += length;
+		anchor = ip;
+	}
+
+	out = putSequence(out, in + anchor, size - anchor, 0, 0);
+
+	return out - start;
+}
+
+static void put32(FILE *file, uint32_t value)
+{
+	fwrite(&value, sizeof(value), 1, file);
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "usage: %s <image> <output>\n", argv[0]);
+		return 1;
+	}
+
+	FILE *input = fopen(argv[1], "rb");
+
+	if (!input)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	fseek(input, 0, SEEK_END);
+	size_t size = ftell(input);
+	fseek(input, 0, SEEK_SET);
+
+	size_t pages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+	uint8_t *image = calloc(pages ? pages : 1, PAGE_SIZE);
+	uint8_t *blocks = malloc((pages ? pages : 1) * (PAGE_SIZE + 64));
+	uint32_t *sizes = calloc(pages ? pages : 1, sizeof(uint32_t));
+
+	if (!image || !blocks || !sizes || fread(image, 1, size, input) != size)
+	{
+		fprintf(stderr, "%s: cannot read the image\n", argv[1]);
+		return 1;
+	}
+
+	fclose(input);
+
+	size_t total = 0;
+
+	for (size_t i = 0; i < pages; i++)
+	{
+		const uint8_t *page = image + i * PAGE_SIZE;
+		size_t length = size - i * PAGE_SIZE < PAGE_SIZE ?
+			size - i * PAGE_SIZE : PAGE_SIZE;
+		size_t compressed = compressBlock(page, length, blocks + total);
+
+		// Store the page as is when it does not compress
+		if (compressed >= length)
+		{
+			memcpy(blocks + total, page, length);
+			compressed = length;
+			sizes[i] = LZ4_BLOCK_RAW | compressed;
+		}
+		else
+		{
+			sizes[i] = compressed;
+		}
+
+		total += compressed;
+	}
+
+	FILE *output = fopen(argv[2], "wb");
+
+	if (!output)
+	{
+		perror(argv[2]);
+		return 1;
+	}
+
+	put32(output, LZ4_IMAGE_MAGIC);
+	put32(output, size);
+
+	// Copy the layout footer ending the image, see include/partitions.h
+	uint8_t layout[LAYOUT_SIZE] = { 0 };
+
+	if (size >= LAYOUT_SIZE)
+	{
+		memcpy(layout, image + size - LAYOUT_SIZE, LAYOUT_SIZE);
+	}
+
+	fwrite(layout, 1, LAYOUT_SIZE, output);
+	fwrite(sizes, sizeof(uint32_t), pages, output);
+	fwrite(blocks, 1, total, output);
+
+	if (fclose(output))
+	{
+		perror(argv[2]);
+		return 1;
+	}
+
+	size_t packed = 8 + LAYOUT_SIZE + pages * sizeof(uint32_t) + total;
+
+	printf("%s: %zu bytes packed into %zu bytes (%zu%%)\n", argv[1],
+			size, packed, size ? packed * 100 / size : 0);
+
+	return 0;
+}
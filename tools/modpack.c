@@ -0,0 +1,341 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * Host tool packing the child images of a partition manifest into a boot
+ * module directory, loaded by the bootloader for the root partition
+ *
+ * Usage: modpack <manifest> <output>
+ *
+ * The manifest has the format of partitions.conf. Each distinct image is
+ * stored once, starting on a page boundary of the directory. The output
+ * format must be kept in sync with struct module_directory in
+ * include/modules.h, and the options table with the CHILD_* flags of
+ * include/partitions.h.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PAGE_SIZE		0x1000
+#define MODULES_MAGIC		0x53444f4d
+#define MODULE_NAME_SIZE	16
+#define HEADER_SIZE		16
+#define ENTRY_SIZE		(MODULE_NAME_SIZE + 28)
+#define MAX_MODULES		64
+
+// The number of cache colors, given by the Makefile as for include/pool.h
+#ifndef POOL_COLORS
+#define POOL_COLORS		32
+#endif
+
+static const struct
+{
+	const char *name;
+	uint32_t flag;
+} options[] =
+{
+	{ "lazy", 0x1 }, { "lz4", 0x2 }, { "timer", 0x4 }, { "fpu", 0x8 }
+};
+
+struct module
+{
+	char name[MODULE_NAME_SIZE];
+	char image[256];
+	uint32_t loadAddress;
+	uint32_t flags;
+	uint32_t colors;
+	uint32_t priority;
+	uint32_t budget;
+	uint32_t offset;
+	uint32_t size;
+	uint8_t *content;
+};
+
+static struct module modules[MAX_MODULES];
+
+static void put32(FILE *file, uint32_t value)
+{
+	fwrite(&value, sizeof(value), 1, file);
+}
+
+static int parseOptions(char *list, struct module *module)
+{
+	for (char *option = strtok(list, ","); option;
+			option = strtok(NULL, ","))
+	{
+		unsigned first, last, value;
+		size_t i;
+
+		// The cache colors are given as a range of colors
+		int bounds = sscanf(option, "colors=%u-%u", &first, &last);
+
+		if (bounds > 0)
+		{
+			if (bounds == 1)
+			{
+				last = first;
+			}
+
+			if (first > last || last >= POOL_COLORS)
+			{
+				return 0;
+			}
+
+			for (; first <= last; first++)
+			{
+				module->colors |= 1U << first;
+			}
+
+			continue;
+		}
+
+		if (sscanf(option, "prio=%u", &value) == 1)
+		{
+			if (value > 7)
+			{
+				return 0;
+			}
+
+			module->priority = value;
+			continue;
+		}
+
+		if (sscanf(option, "budget=%u", &value) == 1)
+		{
+			module->budget = value;
+			continue;
+		}
+
+		for (i = 0; i < sizeof(options) / sizeof(options[0]); i++)
+		{
+			if (!strcmp(option, options[i].name))
+			{
+				module->flags |= options[i].flag;
+				break;
+			}
+		}
+
+		if (i == sizeof(options) / sizeof(options[0]))
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static uint8_t *readImage(const char *path, uint32_t *size)
+{
+	FILE *input = fopen(path, "rb");
+
+	if (!input)
+	{
+		perror(path);
+		return NULL;
+	}
+
+	fseek(input, 0, SEEK_END);
+	*size = ftell(input);
+	fseek(input, 0, SEEK_SET);
+
+	uint8_t *content = malloc(*size ? *size : 1);
+
+	if (!content || fread(content, 1, *size, input) != *size)
+	{
+		fprintf(stderr, "%s: cannot read the image\n", path);
+		return NULL;
+	}
+
+	fclose(input);
+
+	return content;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "usage: %s <manifest> <output>\n", argv[0]);
+		return 1;
+	}
+
+	FILE *manifest = fopen(argv[1], "r");
+
+	if (!manifest)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	char line[512];
+	uint32_t count = 0;
+	uint32_t lineNumber = 0;
+
+	while (fgets(line, sizeof(line), manifest))
+	{
+		char name[64], image[256], load[32], list[128] = "";
+		lineNumber++;
+
+		char *first = line + strspn(line, " \t");
+
+		if (*first == '#' || *first == '\n' || *first == '\0')
+		{
+			continue;
+		}
+
+		int fields = sscanf(line, "%63s %255s %31s %127s", name, image,
+				load, list);
+
+		struct module *module = &modules[count];
+
+		if (fields < 3 || count == MAX_MODULES ||
+				strlen(name) >= MODULE_NAME_SIZE ||
+				!parseOptions(list, module))
+		{
+			fprintf(stderr, "%s:%u: invalid or too many children\n",
+					argv[1], lineNumber);
+			return 1;
+		}
+
+		// Compressed images are built from the image by tools/lz4pack
+		if (module->flags & 0x2)
+		{
+			strncat(image, ".lz4", sizeof(image) - strlen(image) - 1);
+		}
+
+		strcpy(module->name, name);
+		strcpy(module->image, image);
+		module->loadAddress = strtoul(load, NULL, 0);
+		count++;
+	}
+
+	fclose(manifest);
+
+	if (!count)
+	{
+		fprintf(stderr, "%s: no child partition\n", argv[1]);
+		return 1;
+	}
+
+	// Lay out each distinct image once, on a page boundary
+	uint32_t offset = (HEADER_SIZE + count * ENTRY_SIZE + PAGE_SIZE - 1) &
+		~(PAGE_SIZE - 1);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		struct module *module = &modules[i];
+		uint32_t j;
+
+		for (j = 0; j < i && strcmp(modules[j].image, module->image); j++);
+
+		if (j < i)
+		{
+			module->offset = modules[j].offset;
+			module->size   = modules[j].size;
+			continue;
+		}
+
+		module->content = readImage(module->image, &module->size);
+
+		if (!module->content)
+		{
+			return 1;
+		}
+
+		module->offset = offset;
+		offset += (module->size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+	}
+
+	FILE *output = fopen(argv[2], "wb");
+
+	if (!output)
+	{
+		perror(argv[2]);
+		return 1;
+	}
+
+	put32(output, MODULES_MAGIC);
+	put32(output, count);
+	put32(output, offset);
+	put32(output, 0);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		char name[MODULE_NAME_SIZE] = { 0 };
+
+		strcpy(name, modules[i].name);
+		fwrite(name, 1, MODULE_NAME_SIZE, output);
+		put32(output, modules[i].offset);
+		put32(output, modules[i].size);
+		put32(output, modules[i].loadAddress);
+		put32(output, modules[i].flags);
+		put32(output, modules[i].colors);
+		put32(output, modules[i].priority);
+		put32(output, modules[i].budget);
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (!modules[i].content)
+		{
+			continue;
+		}
+
+		fseek(output, modules[i].offset, SEEK_SET);
+		fwrite(modules[i].content, 1, modules[i].size, output);
+	}
+
+	// Pad the last image to a page boundary
+	fseek(output, 0, SEEK_END);
+
+	if ((uint32_t) ftell(output) < offset)
+	{
+		fseek(output, offset - 1, SEEK_SET);
+		fputc(0, output);
+	}
+
+	if (fclose(output))
+	{
+		perror(argv[2]);
+		return 1;
+	}
+
+	printf("%s: %u children packed into %u bytes\n", argv[2], count,
+			offset);
+
+	return 0;
+}
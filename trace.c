@@ -0,0 +1,343 @@
+/*******************************************************************************/
+/*  © Université de Lille, The Pip Development Team (2015-2024)                */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/*!
+ * \file
+ * This file contains the interrupt latency tracer of the root partition.
+ * Each interrupt served by the root is timestamped at its entry stub, when
+ * its handler starts, and when the root yields to resume a child, either
+ * after the handler or when the interrupt is forwarded to the child. The
+ * record is then written into a lock-free ring, in the manner of the
+ * channel rings, and the ring is drained into per-vector histograms on
+ * timer ticks, or by the writer itself when it is full, so that no record
+ * is dropped. The histograms are printed every TRACE_PRINT_TICKS ticks and
+ * on keyboard interrupts:
+ *
+ * TRACE <vector> handler n=<samples> max=<cycles> hist <bucket>:<samples> ...
+ * TRACE <vector> resume n=<samples> max=<cycles> hist <bucket>:<samples> ...
+ *
+ * Bucket k counts the latencies from 2^k to 2^(k+1)-1 cycles, only the
+ * non-empty buckets are printed. The tracing costs three reads of the time
+ * stamp counter and the copy of a record per interrupt.
+ */
+
+#include <stdint.h>
+
+#include <pip/stdio.h>
+
+#include "cycles.h"
+#include "ring.h"
+#include "trace.h"
+
+/*!
+ * \brief The trace ring
+ */
+static struct trace_ring traceRing;
+
+/*!
+ * \brief The record of the interrupt being served
+ */
+static struct trace_record pending;
+
+/*!
+ * \brief The time stamp counter at the entry of the interrupt being served
+ */
+static uint64_t pendingEntry;
+
+/*!
+ * \brief Whether an interrupt is being served
+ */
+static uint32_t pendingValid;
+
+/*!
+ * \brief The latency histograms, one per vector in the order the vectors
+ *        were first drained
+ */
+static struct trace_histogram histograms[TRACE_VECTORS];
+
+/*!
+ * \brief The number of histograms in use
+ */
+static uint32_t histogramsCount;
+
+/*!
+ * \brief The records drained for vectors left without a histogram
+ */
+static uint32_t untracedCount;
+
+/*!
+ * \brief The number of records drained when the histograms were last
+ *        printed
+ */
+static uint32_t printedCount;
+
+/*!
+ * \brief The number of timer ticks since the histograms were last printed
+ */
+static uint32_t ticks;
+
+/*!
+ * \fn static uint32_t bucket(uint32_t cycles)
+ * \brief Compute the histogram bucket of a latency
+ * \param cycles The latency
+ * \return The index of the highest bit set, 0 for a latency of 0 or 1
+ */
+static uint32_t bucket(uint32_t cycles)
+{
+	uint32_t index = 0;
+
+	for (; cycles > 1; cycles >>= 1)
+	{
+		index++;
+	}
+
+	return index;
+}
+
+/*!
+ * \fn static struct trace_histogram *histogramOf(uint32_t vector)
+ * \brief Find the histograms of a vector, taking a free one for a vector
+ *        drained for the first time
+ * \param vector The vector
+ * \return The histograms, 0 if none is left
+ */
+static struct trace_histogram *histogramOf(uint32_t vector)
+{
+	for (uint32_t i = 0; i < histogramsCount; i++)
+	{
+		if (histograms[i].vector == vector)
+		{
+			return &histograms[i];
+		}
+	}
+
+	if (histogramsCount == TRACE_VECTORS)
+	{
+		return 0;
+	}
+
+	histograms[histogramsCount].vector = vector;
+
+	return &histograms[histogramsCount++];
+}
+
+/*!
+ * \fn static void drain(void)
+ * \brief Move the records of the trace ring into the histograms
+ */
+static void drain(void)
+{
+	while (traceRing.head != traceRing.tail)
+	{
+		const struct trace_record *record =
+			&traceRing.records[traceRing.head % TRACE_SLOTS];
+		struct trace_histogram *histogram = histogramOf(record->vector);
+
+		if (!histogram)
+		{
+			untracedCount++;
+		}
+		else
+		{
+			histogram->count++;
+
+			if (record->handler)
+			{
+				histogram->handled++;
+				histogram->handler[bucket(record->handler)]++;
+
+				if (record->handler > histogram->maxHandler)
+				{
+					histogram->maxHandler = record->handler;
+				}
+			}
+
+			histogram->resume[bucket(record->resume)]++;
+
+			if (record->resume > histogram->maxResume)
+			{
+				histogram->maxResume = record->resume;
+			}
+		}
+
+		// Release the slot once the record is read
+		RING_BARRIER();
+		traceRing.head++;
+	}
+}
+
+/*!
+ * \fn static void printHistogram(uint32_t vector, const char *name,
+ *		uint32_t count, uint32_t max, const uint32_t *buckets)
+ * \brief Print a latency histogram
+ * \param vector The vector
+ * \param name The name of the latency
+ * \param count The number of samples
+ * \param max The longest latency
+ * \param buckets The TRACE_BUCKETS buckets
+ */
+static void printHistogram(uint32_t vector, const char *name, uint32_t count,
+		uint32_t max, const uint32_t *buckets)
+{
+	if (!count)
+	{
+		printf("TRACE %d %s n=0\n", vector, name);
+		return;
+	}
+
+	printf("TRACE %d %s n=%d max=%d hist", vector, name, count, max);
+
+	for (uint32_t i = 0; i < TRACE_BUCKETS; i++)
+	{
+		if (buckets[i])
+		{
+			printf(" %d:%d", i, buckets[i]);
+		}
+	}
+
+	printf("\n");
+}
+
+/*!
+ * \fn void traceEntry(uint32_t vector, uint64_t entryCycles)
+ * \brief Start the record of an interrupt
+ * \param vector The vector the interrupt was triggered on
+ * \param entryCycles The time stamp counter read by the entry stub
+ */
+void traceEntry(uint32_t vector, uint64_t entryCycles)
+{
+	pendingEntry    = entryCycles;
+	pending.vector  = vector;
+	pending.entry   = (uint32_t) entryCycles;
+	pending.handler = 0;
+	pendingValid    = 1;
+}
+
+/*!
+ * \fn void traceHandler(void)
+ * \brief Timestamp the start of the root handler of the interrupt
+ */
+void traceHandler(void)
+{
+	if (pendingValid)
+	{
+		pending.handler = (uint32_t) (readCycles() - pendingEntry);
+	}
+}
+
+/*!
+ * \fn void traceResume(void)
+ * \brief Timestamp the yield resuming a child and write the record of the
+ *        interrupt into the trace ring
+ * \note Nothing is recorded when no interrupt is being served, as for the
+ *       first yield of the root partition.
+ */
+void traceResume(void)
+{
+	if (!pendingValid)
+	{
+		return;
+	}
+
+	pending.resume = (uint32_t) (readCycles() - pendingEntry);
+	pendingValid   = 0;
+
+	// The ring is drained by the root only, which makes room itself
+	// rather than dropping the record
+	if (traceRing.tail - traceRing.head == TRACE_SLOTS)
+	{
+		drain();
+	}
+
+	traceRing.records[traceRing.tail % TRACE_SLOTS] = pending;
+
+	// Publish the record once it is written
+	RING_BARRIER();
+	traceRing.tail++;
+}
+
+/*!
+ * \fn void traceTick(void)
+ * \brief Drain the trace ring on a timer tick, and print the histograms
+ *        every TRACE_PRINT_TICKS ticks
+ */
+void traceTick(void)
+{
+	drain();
+
+	if (++ticks == TRACE_PRINT_TICKS)
+	{
+		ticks = 0;
+		printTraceStats();
+	}
+}
+
+/*!
+ * \fn void printTraceStats(void)
+ * \brief Print the latency histograms of the traced vectors if interrupts
+ *        were recorded since the last time they were printed
+ */
+void printTraceStats(void)
+{
+	drain();
+
+	uint32_t count = untracedCount;
+
+	for (uint32_t i = 0; i < histogramsCount; i++)
+	{
+		count += histograms[i].count;
+	}
+
+	if (count == printedCount)
+	{
+		return;
+	}
+
+	printedCount = count;
+
+	for (uint32_t i = 0; i < histogramsCount; i++)
+	{
+		const struct trace_histogram *histogram = &histograms[i];
+
+		printHistogram(histogram->vector, "handler",
+				histogram->handled, histogram->maxHandler,
+				histogram->handler);
+		printHistogram(histogram->vector, "resume", histogram->count,
+				histogram->maxResume, histogram->resume);
+	}
+
+	if (untracedCount)
+	{
+		printf("TRACE untraced n=%d\n", untracedCount);
+	}
+}